@@ -0,0 +1,236 @@
+/* =================================================================================================
+
+(c - GPLv3) T.W.J. de Geus (Tom) | tom@geus.me | www.geus.me | github.com/tdegeus/GooseEYE
+
+================================================================================================= */
+
+#ifndef GOOSEEYE_CLUSTERSET_HPP
+#define GOOSEEYE_CLUSTERSET_HPP
+
+// =================================================================================================
+
+#include "GooseEYE.h"
+
+// =================================================================================================
+
+namespace GooseEYE {
+namespace Private {
+
+// =================================================================================================
+// list of cluster centres: [ [label, h, i, j], ... ] in raster order (3-d). A centre is stored only
+// if it is inside its own cluster ("cntr[k] > 0" and "clus[k] == cntr[k]").
+// =================================================================================================
+
+inline std::vector<int> centreList(const ArrI &clus, const ArrI &cntr)
+{
+  // check
+  if ( clus.shape() != cntr.shape() )
+    throw std::runtime_error("GooseEYE::Private::centreList - shape inconsistent");
+
+  // shape of the image (3-d)
+  size_t shape[3] = {1, 1, 1};
+
+  for ( size_t i = 0 ; i < clus.rank() ; ++i ) shape[i] = clus.shape(i);
+
+  // raw data (row-major storage)
+  const int *C = clus.data();
+  const int *W = cntr.data();
+
+  // extract centres
+  std::vector<int> out;
+
+  for ( size_t k = 0 ; k < clus.size() ; ++k ) {
+    if ( W[k] and C[k] == W[k] ) {
+      int h = static_cast<int>( k / ( shape[1] * shape[2] ) );
+      int i = static_cast<int>( ( k / shape[2] ) % shape[1] );
+      int j = static_cast<int>( k % shape[2] );
+      out.insert(out.end(), {W[k], h, i, j});
+    }
+  }
+
+  return out;
+}
+
+// =================================================================================================
+// hash of an image (shape and data): FNV-1a
+// =================================================================================================
+
+inline size_t hash(const ArrI &f)
+{
+  uint64_t out = 14695981039346656037ull;
+
+  auto add = [&out](uint64_t value) {
+    for ( size_t i = 0 ; i < 8 ; ++i ) {
+      out ^= ( value >> (8*i) ) & 0xff;
+      out *= 1099511628211ull;
+    }
+  };
+
+  for ( auto &i : f.shape() ) add(static_cast<uint64_t>(i));
+
+  for ( size_t i = 0 ; i < f.size() ; ++i ) add(static_cast<uint64_t>(static_cast<uint32_t>(f[i])));
+
+  return static_cast<size_t>(out);
+}
+
+// =================================================================================================
+
+} // namespace Private
+
+// =================================================================================================
+// constructors
+// =================================================================================================
+
+inline
+ClusterSet::ClusterSet(const ArrI &f, const ArrI &kern, int min_size, bool periodic,
+  size_t nthreads) : mPeriodic(periodic)
+{
+  ArrI clus, cntr;
+
+  std::tie(clus, cntr) = Private::clusters(f, kern, min_size, periodic, nthreads);
+
+  // compact list of centres
+  mList = Private::centreList(clus, cntr);
+
+  // centres as [ [label, linear index], ... ] (to reconstruct the image of centres)
+  for ( size_t k = 0 ; k < cntr.size() ; ++k )
+    if ( cntr[k] )
+      mCentres.insert(mCentres.end(), {static_cast<size_t>(cntr[k]), k});
+
+  // number of labels (including the background)
+  size_t nlab = static_cast<size_t>(clus.max()) + 1;
+
+  // shape of the image (3-d)
+  size_t shape[3] = {1, 1, 1};
+
+  for ( size_t i = 0 ; i < clus.rank() ; ++i ) shape[i] = clus.shape(i);
+
+  // bounding box of each label: initialize empty
+  mBox.resize(6*nlab);
+
+  for ( size_t ilab = 0 ; ilab < nlab ; ++ilab ) {
+    for ( size_t i = 0 ; i < 3 ; ++i ) {
+      mBox[6*ilab+i  ] = std::numeric_limits<int>::max();
+      mBox[6*ilab+i+3] = std::numeric_limits<int>::min();
+    }
+  }
+
+  // bounding box of each label: update with each voxel
+  for ( size_t k = 0 ; k < clus.size() ; ++k ) {
+    size_t ilab = static_cast<size_t>(clus[k]);
+    int    x[3] = {
+      static_cast<int>( k / ( shape[1] * shape[2] ) ),
+      static_cast<int>( ( k / shape[2] ) % shape[1] ),
+      static_cast<int>( k % shape[2] )
+    };
+    for ( size_t i = 0 ; i < 3 ; ++i ) {
+      mBox[6*ilab+i  ] = std::min(mBox[6*ilab+i  ], x[i]);
+      mBox[6*ilab+i+3] = std::max(mBox[6*ilab+i+3], x[i]);
+    }
+  }
+
+  // store the labels in the smallest type that holds them
+  mShape = clus.shape();
+  mBits  = GooseEYE::labelBits(clus);
+
+  if ( mBits == 16 ) mLabels16 = compactLabels<uint16_t>(clus);
+  else               mLabels32 = compactLabels<uint32_t>(clus);
+}
+
+// -------------------------------------------------------------------------------------------------
+
+inline
+ClusterSet::ClusterSet(const ArrI &f, bool periodic, size_t nthreads) :
+  ClusterSet(f, kernel(f.rank()), 0, periodic, nthreads)
+{
+}
+
+// =================================================================================================
+// number of clusters (excluding the background)
+// =================================================================================================
+
+inline
+size_t ClusterSet::size() const
+{
+  return mBox.size() / 6 - 1;
+}
+
+// =================================================================================================
+// cluster labels (as image)
+// =================================================================================================
+
+inline
+ArrI ClusterSet::labels() const
+{
+  ArrI out(mShape);
+
+  for ( size_t k = 0 ; k < out.size() ; ++k )
+    out[k] = ( mBits == 16 ) ? static_cast<int>(mLabels16[k]) : static_cast<int>(mLabels32[k]);
+
+  return out;
+}
+
+// =================================================================================================
+// centres (as image: the centre of each cluster is set to its label, see "clusterCenters")
+// =================================================================================================
+
+inline
+ArrI ClusterSet::centres() const
+{
+  ArrI out = ArrI::Zero(mShape);
+
+  for ( size_t k = 0 ; k < mCentres.size() ; k += 2 )
+    out[mCentres[k+1]] = static_cast<int>(mCentres[k]);
+
+  return out;
+}
+
+// =================================================================================================
+// compact list of centres: [ [label, h, (i, (j))], ... ] (as many coordinates as the image's rank)
+// =================================================================================================
+
+inline
+MatI ClusterSet::centreList() const
+{
+  size_t n  = mList.size() / 4;
+  size_t nd = mShape.size();
+
+  MatI out(n, nd+1);
+
+  for ( size_t k = 0 ; k < n ; ++k )
+    for ( size_t i = 0 ; i < nd+1 ; ++i )
+      out(k,i) = mList[4*k+i];
+
+  return out;
+}
+
+// =================================================================================================
+// bounding box of each label: [ [hmin, (imin, (jmin)), hmax, (imax, (jmax))], ... ]
+// N.B. in image coordinates: for a cluster that crosses a periodic edge the box spans the image
+// =================================================================================================
+
+inline
+MatI ClusterSet::boxes() const
+{
+  size_t n  = mBox.size() / 6;
+  size_t nd = mShape.size();
+
+  MatI out = MatI::Zero(n, 2*nd);
+
+  for ( size_t ilab = 1 ; ilab < n ; ++ilab ) {
+    for ( size_t i = 0 ; i < nd ; ++i ) {
+      out(ilab,i   ) = mBox[6*ilab+i  ];
+      out(ilab,i+nd) = mBox[6*ilab+i+3];
+    }
+  }
+
+  return out;
+}
+
+// =================================================================================================
+
+} // namespace ...
+
+// =================================================================================================
+
+#endif
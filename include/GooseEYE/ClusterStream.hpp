@@ -0,0 +1,525 @@
+/* =================================================================================================
+
+(c - GPLv3) T.W.J. de Geus (Tom) | tom@geus.me | www.geus.me | github.com/tdegeus/GooseEYE
+
+================================================================================================= */
+
+#ifndef GOOSEEYE_CLUSTERSTREAM_HPP
+#define GOOSEEYE_CLUSTERSTREAM_HPP
+
+// =================================================================================================
+
+#include "GooseEYE.h"
+
+// =================================================================================================
+
+namespace GooseEYE {
+
+// =================================================================================================
+// constructors
+// =================================================================================================
+
+inline
+ClusterStream::ClusterStream(const VecS &shape, bool periodic) :
+  ClusterStream(shape, kernel(shape.size()+1), periodic)
+{
+}
+
+// -------------------------------------------------------------------------------------------------
+
+inline
+ClusterStream::ClusterStream(const VecS &shape, const ArrI &kern, bool periodic) :
+  mPeriodic(periodic), mClosed(false)
+{
+  // check
+  if ( shape.size() < 1 or shape.size() > 2 )
+    throw std::runtime_error("GooseEYE::ClusterStream - slices must be 1-d or 2-d");
+
+  mRank = shape.size() + 1;
+
+  Private::Connectivity::Value conn = Private::connectivity(kern, mRank);
+
+  if ( conn == Private::Connectivity::other )
+    throw std::runtime_error("GooseEYE::ClusterStream - only the default and the full kernel");
+
+  mFull = ( conn == Private::Connectivity::full );
+
+  // shape: a slice is stored as 2-d
+  mShape[0] = 0;
+  mShape[1] = ( mRank == 3 ) ? static_cast<int>(shape[0]) : 1;
+  mShape[2] = static_cast<int>(shape.back());
+
+  // index "0" is the background
+  mActive.resize(1);
+}
+
+// =================================================================================================
+// voxels of a neighbouring slice that are connected to voxel "k" of a slice
+// =================================================================================================
+
+template<class Func>
+inline void ClusterStream::neighbours(size_t k, Func func) const
+{
+  int I = mShape[1];
+  int J = mShape[2];
+  int i = static_cast<int>( k / J );
+  int j = static_cast<int>( k % J );
+
+  // face connectivity: only the voxel at the same position
+  if ( ! mFull ) { int n[3] = {0, 0, 0}; func(k, n); return; }
+
+  // full connectivity: all voxels within one position (periodic: across the edges of the slice)
+  for ( int di = -1 ; di <= 1 ; ++di ) {
+    for ( int dj = -1 ; dj <= 1 ; ++dj ) {
+
+      if ( mRank < 3 and di != 0 ) continue;
+
+      int a = i + di;
+      int b = j + dj;
+      int n[3] = {0, 0, 0};
+
+      if ( mPeriodic ) {
+        n[1] = ( a + I ) / I - 1;
+        n[2] = ( b + J ) / J - 1;
+        a   -= n[1] * I;
+        b   -= n[2] * J;
+      }
+      else if ( a < 0 or a >= I or b < 0 or b >= J ) {
+        continue;
+      }
+
+      func(static_cast<size_t>(a) * J + b, n);
+    }
+  }
+}
+
+// =================================================================================================
+// root cluster in the first slice, and the periodic image of "a" relative to it (the path is linked
+// directly to the root)
+// =================================================================================================
+
+inline
+int ClusterStream::firstRoot(int a, int image[3])
+{
+  // - root, periodic image relative to it
+  int r = a;
+
+  for ( size_t ax = 0 ; ax < 3 ; ++ax ) image[ax] = 0;
+
+  while ( mFirstLinks[r] != r ) {
+    for ( size_t ax = 0 ; ax < 3 ; ++ax ) image[ax] += mFirstShift[3*r+ax];
+    r = mFirstLinks[r];
+  }
+
+  // - link the path to the root
+  int shift[3] = {image[0], image[1], image[2]};
+
+  while ( mFirstLinks[a] != a ) {
+    int next = mFirstLinks[a];
+    mFirstLinks[a] = r;
+    for ( size_t ax = 0 ; ax < 3 ; ++ax ) {
+      int s = mFirstShift[3*a+ax];
+      mFirstShift[3*a+ax] = shift[ax];
+      shift[ax] -= s;
+    }
+    a = next;
+  }
+
+  return r;
+}
+
+// =================================================================================================
+// add a voxel to a cluster (its position unwrapped, i.e. in the periodic image of the cluster)
+// =================================================================================================
+
+inline
+void ClusterStream::add(Sums &s, int h, int i, int j) const
+{
+  // first voxel: reference
+  if ( s.n == 0 ) {
+    s.ref[0] = h;
+    s.ref[1] = i;
+    s.ref[2] = j;
+  }
+
+  // position relative to the reference
+  int d[3] = {h - s.ref[0], i - s.ref[1], j - s.ref[2]};
+
+  // update the bounding box, the size, and the sums
+  for ( size_t a = 0 ; a < 3 ; ++a ) {
+    if ( s.n == 0 or d[a] < s.lo[a] ) s.lo[a] = d[a];
+    if ( s.n == 0 or d[a] > s.hi[a] ) s.hi[a] = d[a];
+  }
+
+  s.n++;
+
+  for ( size_t a = 0 ; a < 3 ; ++a ) {
+    s.s1[a] += d[a];
+    for ( size_t b = 0 ; b < 3 ; ++b )
+      s.s2[3*a+b] += static_cast<int64_t>(d[a]) * d[b];
+  }
+}
+
+// =================================================================================================
+// merge cluster "b" into cluster "a", with "b" in the periodic image "shift" relative to "a" (the
+// sums of "b" are shifted to the reference of "a")
+// =================================================================================================
+
+inline
+void ClusterStream::merge(Sums &a, const Sums &b, const int shift[3])
+{
+  // position of the reference of "b" relative to that of "a"
+  int64_t d[3];
+
+  for ( size_t i = 0 ; i < 3 ; ++i )
+    d[i] = b.ref[i] + static_cast<int64_t>(shift[i]) * mShape[i] - a.ref[i];
+
+  // shift the bounding box and the sums: "x -> x + d"
+  for ( size_t i = 0 ; i < 3 ; ++i ) {
+    a.lo[i] = std::min(a.lo[i], b.lo[i] + static_cast<int>(d[i]));
+    a.hi[i] = std::max(a.hi[i], b.hi[i] + static_cast<int>(d[i]));
+  }
+
+  for ( size_t i = 0 ; i < 3 ; ++i )
+    for ( size_t j = 0 ; j < 3 ; ++j )
+      a.s2[3*i+j] += b.s2[3*i+j] + d[i] * b.s1[j] + d[j] * b.s1[i] + b.n * d[i] * d[j];
+
+  for ( size_t i = 0 ; i < 3 ; ++i ) a.s1[i] += b.s1[i] + b.n * d[i];
+
+  a.n += b.n;
+
+  // periodic: link the clusters in the first slice, such that their relative periodic image is
+  // that in the merged cluster (a cluster that is connected to its own periodic image is not
+  // unwrapped)
+  if ( a.first and b.first )
+  {
+    int ia[3], ib[3];
+    int ra = firstRoot(a.first, ia);
+    int rb = firstRoot(b.first, ib);
+
+    if ( ra != rb ) {
+      mFirstLinks[rb] = ra;
+      for ( size_t i = 0 ; i < 3 ; ++i )
+        mFirstShift[3*rb+i] = b.image[i] + shift[i] - a.image[i] + ia[i] - ib[i];
+    }
+  }
+  else if ( b.first )
+  {
+    a.first = b.first;
+    for ( size_t i = 0 ; i < 3 ; ++i ) a.image[i] = b.image[i] + shift[i];
+  }
+}
+
+// =================================================================================================
+// merge the clusters of "mActive" that are linked into their root (in its periodic image)
+// =================================================================================================
+
+inline
+void ClusterStream::join(Private::OffsetUnionFind &links)
+{
+  for ( size_t a = 1 ; a < mActive.size() ; ++a ) {
+    int o[3];
+    int r = links.find(static_cast<int>(a), o);
+    if ( r != static_cast<int>(a) ) merge(mActive[r], mActive[a], o);
+  }
+}
+
+// =================================================================================================
+// store a finished cluster (periodic: clusters that intersect the first slice wait for "close")
+// =================================================================================================
+
+inline
+void ClusterStream::finish(const Sums &s)
+{
+  if ( mPeriodic and s.first ) mHeld.push_back(s);
+  else                         mDone.push_back(s);
+}
+
+// =================================================================================================
+// read the next slice
+// =================================================================================================
+
+inline
+void ClusterStream::push(const ArrI &slice)
+{
+  // check
+  if ( mClosed )
+    throw std::runtime_error("GooseEYE::ClusterStream::push - already closed");
+
+  VecS shape = {static_cast<size_t>(mShape[2])};
+
+  if ( mRank == 3 ) shape.insert(shape.begin(), static_cast<size_t>(mShape[1]));
+
+  if ( slice.shape() != shape )
+    throw std::runtime_error("GooseEYE::ClusterStream::push - shape inconsistent");
+
+  // position of the slice, and number of voxels
+  int    h = mShape[0];
+  int    I = mShape[1];
+  int    J = mShape[2];
+  size_t N = slice.size();
+
+  // - label the runs of the slice, not linked across its edges (in order of first appearance)
+  int view[3] = {1, 1, 1};
+
+  for ( size_t i = 0 ; i < mRank-1 ; ++i ) view[i] = slice.shape<int>(i);
+
+  Private::Connectivity::Value conn = mFull ? Private::Connectivity::full :
+                                              Private::Connectivity::face;
+
+  Private::RunLabels runs = Private::cclRuns(slice.data(), view, mRank-1, conn, false);
+
+  std::vector<int> L(N);
+
+  runs.paint(L.data());
+
+  int nlab = runs.nlab;
+
+  // - periodic: link the labels across the edges of the slice, keeping track of their periodic image
+  Private::OffsetUnionFind parts(static_cast<size_t>(nlab));
+
+  if ( mPeriodic )
+    Private::cclRunsPeriodic(runs, [&](size_t a, size_t b, const int shift[3]) {
+      parts.unite(runs.label[a], runs.label[b], shift);
+    });
+
+  // - clusters: "1, ..., p" intersect the previous slice, "p+1, ..." are those of this slice
+  //   (in order of first appearance): cluster of each label, and its periodic image in the cluster
+  int p = static_cast<int>( mActive.size() ) - 1;
+
+  std::vector<int> clus (nlab, 0);
+  std::vector<int> image(3*nlab, 0);
+  std::vector<int> num  (nlab, 0);
+
+  int nclus = 0;
+
+  for ( int a = 1 ; a < nlab ; ++a ) {
+    int r = parts.find(a, &image[3*a]);
+    if ( ! num[r] ) num[r] = ++nclus;
+    clus[a] = p + num[r];
+  }
+
+  mActive.resize(p + nclus + 1, Sums());
+
+  for ( size_t k = 0 ; k < N ; ++k ) {
+    if ( L[k] ) {
+      const int *o = &image[3*L[k]];
+      add(mActive[clus[L[k]]], h, static_cast<int>( k / J ) + o[1] * I,
+        static_cast<int>( k % J ) + o[2] * J);
+    }
+  }
+
+  // - periodic: labels of the first slice
+  if ( mPeriodic and h == 0 ) {
+    mFirst      = L;
+    mFirstClus  = clus;
+    mFirstImage = image;
+    mFirstLinks.resize(nclus + 1);
+    mFirstShift.assign(3 * ( nclus + 1 ), 0);
+    std::iota(mFirstLinks.begin(), mFirstLinks.end(), 0);
+    for ( int a = 1 ; a <= nclus ; ++a ) mActive[a].first = a;
+  }
+
+  // - link to the clusters of the previous slice, keeping track of their periodic image
+  Private::OffsetUnionFind links(mActive.size());
+
+  if ( h > 0 ) {
+    for ( size_t k = 0 ; k < N ; ++k ) {
+      if ( L[k] ) {
+        neighbours(k, [&](size_t q, const int n[3]) {
+          int a = L[k], b = mPrev[q];
+          if ( ! b ) return;
+          int shift[3];
+          for ( size_t ax = 0 ; ax < 3 ; ++ax )
+            shift[ax] = n[ax] + image[3*a+ax] - mPrevImage[3*b+ax];
+          links.unite(clus[a], mPrevClus[b], shift);
+        });
+      }
+    }
+  }
+
+  // - merge the linked clusters
+  join(links);
+
+  // - clusters that intersect the slice, renumbered in order of appearance: cluster of each label,
+  //   and its periodic image in the cluster
+  std::vector<int>  renum(mActive.size(), 0);
+  std::vector<Sums> next(1);
+
+  for ( int a = 1 ; a < nlab ; ++a ) {
+    int o[3];
+    int r = links.find(clus[a], o);
+    if ( ! renum[r] ) {
+      renum[r] = static_cast<int>( next.size() );
+      next.push_back(mActive[r]);
+    }
+    clus[a] = renum[r];
+    for ( size_t ax = 0 ; ax < 3 ; ++ax ) image[3*a+ax] += o[ax];
+  }
+
+  // - finished clusters: clusters of the previous slice that do not intersect the slice
+  for ( int a = 1 ; a <= p ; ++a ) {
+    int o[3];
+    if ( links.find(a, o) == a and ! renum[a] )
+      finish(mActive[a]);
+  }
+
+  // - store
+  mActive   .swap(next);
+  mPrev     .swap(L);
+  mPrevClus .swap(clus);
+  mPrevImage.swap(image);
+  mShape[0]++;
+}
+
+// =================================================================================================
+// end of the image
+// =================================================================================================
+
+inline
+void ClusterStream::close()
+{
+  if ( mClosed ) return;
+
+  mClosed = true;
+
+  int H = mShape[0];
+
+  // periodic: merge the clusters that touch across the last and the first slice
+  if ( mPeriodic and H > 0 )
+  {
+    // - all clusters that may touch the first slice: those that intersect the last slice, and those
+    //   that are held
+    for ( auto &s : mHeld ) mActive.push_back(s);
+
+    // - cluster of each cluster of the first slice, and its periodic image in it
+    size_t nfirst = mFirstLinks.size();
+
+    std::vector<int> node (nfirst, 0);
+    std::vector<int> root (nfirst, 0);
+    std::vector<int> image(3*nfirst, 0);
+    std::vector<int> rootImage(3*nfirst, 0);
+
+    for ( size_t a = 1 ; a < mActive.size() ; ++a ) {
+      if ( mActive[a].first ) {
+        int o[3];
+        int r = firstRoot(mActive[a].first, o);
+        root[r] = static_cast<int>(a);
+        for ( size_t ax = 0 ; ax < 3 ; ++ax ) rootImage[3*r+ax] = mActive[a].image[ax] - o[ax];
+      }
+    }
+
+    for ( size_t c = 1 ; c < nfirst ; ++c ) {
+      int r = firstRoot(static_cast<int>(c), &image[3*c]);
+      node[c] = root[r];
+      for ( size_t ax = 0 ; ax < 3 ; ++ax ) image[3*c+ax] += rootImage[3*r+ax];
+    }
+
+    // - link the voxels of the last slice to those of the first slice (one period further along
+    //   the first axis)
+    Private::OffsetUnionFind links(mActive.size());
+
+    for ( size_t k = 0 ; k < mPrev.size() ; ++k ) {
+      if ( mPrev[k] ) {
+        neighbours(k, [&](size_t q, const int n[3]) {
+          int a = mFirst[q], b = mPrev[k];
+          if ( ! a ) return;
+          int c = mFirstClus[a];
+          int shift[3];
+          for ( size_t ax = 0 ; ax < 3 ; ++ax )
+            shift[ax] = n[ax] + mPrevImage[3*b+ax] - mFirstImage[3*a+ax] - image[3*c+ax];
+          shift[0] += 1;
+          links.unite(mPrevClus[b], node[c], shift);
+        });
+      }
+    }
+
+    // - merge, store
+    join(links);
+
+    for ( size_t a = 1 ; a < mActive.size() ; ++a ) {
+      int o[3];
+      if ( links.find(static_cast<int>(a), o) == static_cast<int>(a) )
+        mDone.push_back(mActive[a]);
+    }
+  }
+  else
+  {
+    for ( size_t a = 1 ; a < mActive.size() ; ++a )
+      mDone.push_back(mActive[a]);
+  }
+
+  // release memory
+  mActive.resize(1);
+  mHeld      .clear();
+  mPrev      .clear();
+  mPrevClus  .clear();
+  mPrevImage .clear();
+  mFirst     .clear();
+  mFirstClus .clear();
+  mFirstImage.clear();
+  mFirstLinks.clear();
+  mFirstShift.clear();
+}
+
+// =================================================================================================
+// clusters finished since the previous call
+// =================================================================================================
+
+inline
+ClusterTable ClusterStream::pop()
+{
+  ClusterTable out;
+
+  out.mRank = mRank;
+
+  // axis of the image of each axis of the (3-d) view of the image
+  size_t ax[3] = {0, 1, 2};
+
+  if ( mRank == 2 ) { ax[1] = 2; ax[2] = 1; }
+
+  int shape[3];
+
+  for ( size_t v = 0 ; v < 3 ; ++v ) shape[ax[v]] = mShape[v];
+
+  // collect the sums (the reference voxel wrapped into the image)
+  size_t nlab = mDone.size() + 1;
+
+  std::vector<int>     ref(3*nlab, 0);
+  std::vector<int64_t> s1 (3*nlab, 0);
+  std::vector<int64_t> s2 (9*nlab, 0);
+
+  out.mSize.assign(nlab, 0);
+  out.mBox .assign(6*nlab, 0);
+
+  for ( size_t ilab = 1 ; ilab < nlab ; ++ilab )
+  {
+    const Sums &s = mDone[ilab-1];
+
+    out.mSize[ilab] = static_cast<int>(s.n);
+
+    for ( size_t v = 0 ; v < 3 ; ++v ) {
+      ref[3*ilab+ax[v]] = ( s.ref[v] % mShape[v] + mShape[v] ) % mShape[v];
+      s1 [3*ilab+ax[v]] = s.s1 [v];
+      out.mBox[6*ilab+ax[v]  ] = s.lo[v];
+      out.mBox[6*ilab+ax[v]+3] = s.hi[v];
+      for ( size_t w = 0 ; w < 3 ; ++w )
+        s2[9*ilab+3*ax[v]+ax[w]] = s.s2[3*v+w];
+    }
+  }
+
+  mDone.clear();
+
+  // convert to centroid and central moments (periodic: wrapped into the slices read so far)
+  out.finalize(shape, mPeriodic, ref, s1, s2);
+
+  return out;
+}
+
+// =================================================================================================
+
+} // namespace ...
+
+// =================================================================================================
+
+#endif
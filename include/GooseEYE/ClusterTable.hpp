@@ -0,0 +1,451 @@
+/* =================================================================================================
+
+(c - GPLv3) T.W.J. de Geus (Tom) | tom@geus.me | www.geus.me | github.com/tdegeus/GooseEYE
+
+================================================================================================= */
+
+#ifndef GOOSEEYE_CLUSTERTABLE_HPP
+#define GOOSEEYE_CLUSTERTABLE_HPP
+
+// =================================================================================================
+
+#include "GooseEYE.h"
+
+// =================================================================================================
+
+namespace GooseEYE {
+
+// =================================================================================================
+// constructor: one pass over the image
+// =================================================================================================
+
+inline
+ClusterTable::ClusterTable(const ArrI &labels, bool periodic)
+{
+  measure(labels, periodic);
+}
+
+// -------------------------------------------------------------------------------------------------
+
+inline
+void ClusterTable::measure(const ArrI &labels, bool periodic, const std::vector<int> *clus,
+  const std::vector<int> *image)
+{
+  mRank = labels.rank();
+
+  // shape of the image (3-d)
+  int shape[3] = {1, 1, 1};
+
+  for ( size_t i = 0 ; i < mRank ; ++i ) shape[i] = labels.shape<int>(i);
+
+  // raw data (row-major storage)
+  const int *L = labels.data();
+
+  // number of labels (including the background)
+  int nlab = 1;
+
+  for ( size_t k = 0 ; k < labels.size() ; ++k ) {
+    if ( L[k] < 0 ) throw std::runtime_error("GooseEYE::ClusterTable - labels must be positive");
+    nlab = std::max(nlab, L[k]+1);
+  }
+
+  if ( clus ) nlab = *std::max_element(clus->begin(), clus->end()) + 1;
+
+  // per label: reference voxel (first voxel, in the image and unwrapped), and sums of the
+  // positions relative to it (integers: exact, independent of the order of summation)
+  std::vector<int>     ref(3*nlab, 0);
+  std::vector<int64_t> u  (3*nlab, 0);
+  std::vector<int64_t> s1 (3*nlab, 0);
+  std::vector<int64_t> s2 (9*nlab, 0);
+
+  mSize.assign(nlab, 0);
+  mBox .assign(6*nlab, 0);
+
+  // loop over the image
+  for ( int h = 0 ; h < shape[0] ; ++h ) {
+    for ( int i = 0 ; i < shape[1] ; ++i ) {
+      for ( int j = 0 ; j < shape[2] ; ++j ) {
+
+        int ilab = L[ ( static_cast<size_t>(h) * shape[1] + i ) * shape[2] + j ];
+
+        if ( ilab == 0 ) continue;
+
+        // - position (unwrapped: in the periodic image of the label), cluster of the label
+        int     x[3] = {h, i, j};
+        int64_t y[3] = {h, i, j};
+
+        if ( clus ) {
+          for ( size_t ax = 0 ; ax < 3 ; ++ax )
+            y[ax] += static_cast<int64_t>((*image)[3*ilab+ax]) * shape[ax];
+          ilab = (*clus)[ilab];
+        }
+
+        // - first voxel of the label: reference
+        if ( mSize[ilab] == 0 ) {
+          for ( size_t ax = 0 ; ax < 3 ; ++ax ) {
+            ref[3*ilab+ax] = x[ax];
+            u  [3*ilab+ax] = y[ax];
+          }
+        }
+
+        // - position relative to the reference
+        //   (periodic, periodic images not known: nearest image, "-N/2 < dx <= N/2")
+        int64_t dx[3];
+
+        for ( size_t ax = 0 ; ax < 3 ; ++ax ) {
+          int64_t d = y[ax] - u[3*ilab+ax];
+          if ( periodic and ! clus ) {
+            if      ( 2 * d >   shape[ax] ) d -= shape[ax];
+            else if ( 2 * d <= -shape[ax] ) d += shape[ax];
+          }
+          dx[ax] = d;
+        }
+
+        // - update the bounding box (relative to the reference)
+        for ( size_t ax = 0 ; ax < 3 ; ++ax ) {
+          int d = static_cast<int>(dx[ax]);
+          if ( mSize[ilab] == 0 or d < mBox[6*ilab+ax  ] ) mBox[6*ilab+ax  ] = d;
+          if ( mSize[ilab] == 0 or d > mBox[6*ilab+ax+3] ) mBox[6*ilab+ax+3] = d;
+        }
+
+        // - update the size and the sums
+        mSize[ilab]++;
+
+        for ( size_t a = 0 ; a < 3 ; ++a ) {
+          s1[3*ilab+a] += dx[a];
+          for ( size_t b = 0 ; b < 3 ; ++b )
+            s2[9*ilab+3*a+b] += dx[a] * dx[b];
+        }
+      }
+    }
+  }
+
+  // convert the sums to centroid and central moments, the bounding box to image coordinates
+  finalize(shape, periodic, ref, s1, s2);
+}
+
+// =================================================================================================
+// constructor: labels of the runs of voxels of a binary image (one pass over the runs)
+// =================================================================================================
+
+inline
+ClusterTable::ClusterTable(const Private::RunLabels &runs, bool periodic)
+{
+  mRank = runs.rank;
+
+  // shape of the view of the image with the runs along the last axis, axis of the image of each
+  // axis of the view (the view is a cyclic permutation of the axes of the image)
+  const int *S = runs.shape;
+
+  size_t ax[3];
+  int    shape[3];
+
+  for ( size_t v = 0 ; v < 3 ; ++v ) {
+    ax[v]        = ( v + runs.rank ) % 3;
+    shape[ax[v]] = S[v];
+  }
+
+  // cluster of each label, and the periodic image of the label in its cluster (axes of the view);
+  // periodic: the labels are linked across the edges of the image (see "OffsetUnionFind")
+  std::vector<int> clus (runs.nlab);
+  std::vector<int> image(3*runs.nlab, 0);
+
+  std::iota(clus.begin(), clus.end(), 0);
+
+  int nlab = runs.nlab;
+
+  if ( periodic )
+  {
+    Private::OffsetUnionFind links(static_cast<size_t>(runs.nlab));
+
+    // - link (a cluster that is connected to its own periodic image is not unwrapped)
+    Private::cclRunsPeriodic(runs, [&](size_t a, size_t b, const int shift[3]) {
+      links.unite(runs.label[a], runs.label[b], shift);
+    });
+
+    // - clusters in order of first appearance (the lowest label)
+    std::vector<int> num(runs.nlab, 0);
+
+    nlab = 1;
+
+    for ( int ilab = 1 ; ilab < runs.nlab ; ++ilab ) {
+      int r = links.find(ilab, &image[3*ilab]);
+      if ( num[r] == 0 ) num[r] = nlab++;
+      clus[ilab] = num[r];
+    }
+  }
+
+  // per cluster: reference voxel (first voxel, in the image and unwrapped; axes of the view), and
+  // sums of the positions relative to it
+  std::vector<int>     ref(3*nlab, 0);
+  std::vector<int64_t> u  (3*nlab, 0);
+  std::vector<int64_t> s1 (3*nlab, 0);
+  std::vector<int64_t> s2 (9*nlab, 0);
+
+  mSize.assign(nlab, 0);
+  mBox .assign(6*nlab, 0);
+
+  // loop over the runs
+  for ( size_t r = 0 ; r + 1 < runs.row.size() ; ++r )
+  {
+    int h = static_cast<int>( r / S[1] );
+    int i = static_cast<int>( r % S[1] );
+
+    for ( size_t n = runs.row[r] ; n < runs.row[r+1] ; ++n )
+    {
+      int        ilab = clus[runs.label[n]];
+      const int *o    = &image[3*runs.label[n]];
+
+      // - position of the first voxel of the run (unwrapped: in the periodic image of the label)
+      int64_t y[3] = {
+        h             + static_cast<int64_t>(o[0]) * S[0],
+        i             + static_cast<int64_t>(o[1]) * S[1],
+        runs.begin[n] + static_cast<int64_t>(o[2]) * S[2]
+      };
+
+      // - first voxel of the cluster: reference
+      if ( mSize[ilab] == 0 ) {
+        ref[3*ilab+ax[0]] = h;
+        ref[3*ilab+ax[1]] = i;
+        ref[3*ilab+ax[2]] = runs.begin[n];
+        for ( size_t v = 0 ; v < 3 ; ++v ) u[3*ilab+v] = y[v];
+      }
+
+      // - position relative to the reference: "(dh, di, d0 + 0, ..., d0 + m-1)"
+      int64_t dh = y[0] - u[3*ilab+0];
+      int64_t di = y[1] - u[3*ilab+1];
+      int64_t d0 = y[2] - u[3*ilab+2];
+      int64_t m  = runs.end[n] - runs.begin[n];
+
+      // - sum of "d" and "d^2" for "d = d0, ..., d0+m-1"
+      int64_t sd  = m * d0 + m * ( m - 1 ) / 2;
+      int64_t sdd = m * d0 * d0 + d0 * m * ( m - 1 ) + ( m - 1 ) * m * ( 2 * m - 1 ) / 6;
+
+      // - update the bounding box (relative to the reference)
+      int lo[3] = {static_cast<int>(dh), static_cast<int>(di), static_cast<int>(d0        )};
+      int hi[3] = {static_cast<int>(dh), static_cast<int>(di), static_cast<int>(d0 + m - 1)};
+
+      for ( size_t v = 0 ; v < 3 ; ++v ) {
+        int a = static_cast<int>(ax[v]);
+        if ( mSize[ilab] == 0 or lo[v] < mBox[6*ilab+a  ] ) mBox[6*ilab+a  ] = lo[v];
+        if ( mSize[ilab] == 0 or hi[v] > mBox[6*ilab+a+3] ) mBox[6*ilab+a+3] = hi[v];
+      }
+
+      // - update the size and the sums
+      int64_t sv [3] = {m * dh, m * di, sd};
+      int64_t svv[3][3] = {
+        {m * dh * dh, m * dh * di, dh * sd},
+        {m * di * dh, m * di * di, di * sd},
+        {dh * sd    , di * sd    , sdd    },
+      };
+
+      mSize[ilab] += static_cast<int>(m);
+
+      for ( size_t v = 0 ; v < 3 ; ++v ) {
+        s1[3*ilab+ax[v]] += sv[v];
+        for ( size_t w = 0 ; w < 3 ; ++w )
+          s2[9*ilab+3*ax[v]+ax[w]] += svv[v][w];
+      }
+    }
+  }
+
+  // convert the sums to centroid and central moments, the bounding box to image coordinates
+  finalize(shape, periodic, ref, s1, s2);
+}
+
+// =================================================================================================
+// convert the sums of the (relative) positions to centroid and central moments, and the bounding
+// box to image coordinates
+// =================================================================================================
+
+inline
+void ClusterTable::finalize(const int shape[3], bool periodic, const std::vector<int> &ref,
+  const std::vector<int64_t> &s1, const std::vector<int64_t> &s2)
+{
+  size_t nlab = mSize.size();
+
+  mCentroid.assign(3*nlab, 0.0);
+  mMoment  .assign(9*nlab, 0.0);
+
+  for ( size_t ilab = 1 ; ilab < nlab ; ++ilab )
+  {
+    if ( mSize[ilab] == 0 ) continue;
+
+    double n = static_cast<double>(mSize[ilab]);
+
+    for ( size_t a = 0 ; a < 3 ; ++a )
+    {
+      // - mean position relative to the reference
+      double m = static_cast<double>(s1[3*ilab+a]) / n;
+
+      // - centroid (periodic: wrapped into the image)
+      double c = static_cast<double>(ref[3*ilab+a]) + m;
+
+      if ( periodic ) {
+        c = std::fmod(c, static_cast<double>(shape[a]));
+        if ( c < 0.0 ) c += static_cast<double>(shape[a]);
+      }
+
+      mCentroid[3*ilab+a] = c;
+
+      // - central moments
+      for ( size_t b = 0 ; b < 3 ; ++b )
+        mMoment[9*ilab+3*a+b] = static_cast<double>(s2[9*ilab+3*a+b]) / n -
+          m * static_cast<double>(s1[3*ilab+b]) / n;
+
+      // - bounding box
+      mBox[6*ilab+a  ] += ref[3*ilab+a];
+      mBox[6*ilab+a+3] += ref[3*ilab+a];
+    }
+  }
+}
+
+// =================================================================================================
+// number of voxels per label
+// =================================================================================================
+
+inline
+ArrI ClusterTable::sizes() const
+{
+  ArrI out = ArrI::Zero({mSize.size()});
+
+  for ( size_t ilab = 0 ; ilab < mSize.size() ; ++ilab ) out[ilab] = mSize[ilab];
+
+  return out;
+}
+
+// =================================================================================================
+// centroid per label: [ [h, (i, (j))], ... ]
+// =================================================================================================
+
+inline
+MatD ClusterTable::centroids() const
+{
+  MatD out = MatD::Zero(mSize.size(), mRank);
+
+  for ( size_t ilab = 0 ; ilab < mSize.size() ; ++ilab )
+    for ( size_t i = 0 ; i < mRank ; ++i )
+      out(ilab,i) = mCentroid[3*ilab+i];
+
+  return out;
+}
+
+// =================================================================================================
+// bounding box per label: [ [hmin, (imin, (jmin)), hmax, (imax, (jmax))], ... ]
+// =================================================================================================
+
+inline
+MatI ClusterTable::boxes() const
+{
+  MatI out = MatI::Zero(mSize.size(), 2*mRank);
+
+  for ( size_t ilab = 0 ; ilab < mSize.size() ; ++ilab ) {
+    for ( size_t i = 0 ; i < mRank ; ++i ) {
+      out(ilab,i      ) = mBox[6*ilab+i  ];
+      out(ilab,i+mRank) = mBox[6*ilab+i+3];
+    }
+  }
+
+  return out;
+}
+
+// =================================================================================================
+// second central moments per label: [ [ [hh, (hi, (hj))], ... ], ... ]
+// =================================================================================================
+
+inline
+ArrD ClusterTable::moments() const
+{
+  ArrD out = ArrD::Zero({mSize.size(), mRank, mRank});
+
+  for ( size_t ilab = 0 ; ilab < mSize.size() ; ++ilab )
+    for ( size_t a = 0 ; a < mRank ; ++a )
+      for ( size_t b = 0 ; b < mRank ; ++b )
+        out(ilab,a,b) = mMoment[9*ilab+3*a+b];
+
+  return out;
+}
+
+// =================================================================================================
+// front-end: properties of the clusters of a binary image (labelling the runs of voxels, such that
+// memory and time scale with the number of runs). The image is labelled as if it were not periodic,
+// periodic: the labels are linked across the edges of the image keeping track of their periodic
+// image, such that each cluster is unwrapped exactly (as in "clusters").
+// =================================================================================================
+
+ClusterTable clusterTable(const ArrI &f, const ArrI &kern, bool periodic)
+{
+  ClusterTable out;
+
+  // connectivity described by the kernel (ignoring trailing axes of shape 1, like "clusters")
+  size_t rank = f.rank();
+
+  while ( rank > 1 and f.shape(rank-1) == 1 ) --rank;
+
+  Private::Connectivity::Value conn = Private::connectivity(kern, rank);
+
+  // general kernel: label the voxels
+  if ( conn == Private::Connectivity::other )
+  {
+    ArrI labels = clusters(f, kern, 0, false);
+
+    if ( ! periodic ) { out.measure(labels, false); return out; }
+
+    // - link the labels across the edges of the image (3-d)
+    ArrI F = f, L = labels, K = kern;
+
+    F.chrank(3);
+    L.chrank(3);
+    K.chrank(3);
+
+    size_t nlab = static_cast<size_t>(labels.max()) + 1;
+
+    Private::OffsetUnionFind links(nlab);
+
+    Private::linkPeriodic(F, L, Private::KernelOffsets(K), links);
+
+    // - cluster of each label in order of first appearance (the lowest label), and the periodic
+    //   image of the label in its cluster
+    std::vector<int> clus (nlab, 0);
+    std::vector<int> image(3*nlab, 0);
+    std::vector<int> num  (nlab, 0);
+
+    int n = 0;
+
+    for ( size_t ilab = 1 ; ilab < nlab ; ++ilab ) {
+      int r = links.find(static_cast<int>(ilab), &image[3*ilab]);
+      if ( num[r] == 0 ) num[r] = ++n;
+      clus[ilab] = num[r];
+    }
+
+    out.measure(labels, true, &clus, &image);
+
+    return out;
+  }
+
+  // default or full kernel: label the runs (not linked across the edges, see "ClusterTable")
+  int shape[3] = {1, 1, 1};
+
+  for ( size_t i = 0 ; i < rank ; ++i ) shape[i] = f.shape<int>(i);
+
+  out = ClusterTable(Private::cclRuns(f.data(), shape, rank, conn, false), periodic);
+
+  out.mRank = f.rank();
+
+  return out;
+}
+
+// -------------------------------------------------------------------------------------------------
+
+ClusterTable clusterTable(const ArrI &f, bool periodic)
+{
+  return clusterTable(f, kernel(f.rank()), periodic);
+}
+
+// =================================================================================================
+
+} // namespace ...
+
+// =================================================================================================
+
+#endif
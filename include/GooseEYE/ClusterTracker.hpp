@@ -0,0 +1,271 @@
+/* =================================================================================================
+
+(c - GPLv3) T.W.J. de Geus (Tom) | tom@geus.me | www.geus.me | github.com/tdegeus/GooseEYE
+
+================================================================================================= */
+
+#ifndef GOOSEEYE_CLUSTERTRACKER_HPP
+#define GOOSEEYE_CLUSTERTRACKER_HPP
+
+// =================================================================================================
+
+#include "GooseEYE.h"
+
+// =================================================================================================
+
+namespace GooseEYE {
+
+// =================================================================================================
+// constructors
+// =================================================================================================
+
+inline
+ClusterTracker::ClusterTracker(const ArrI &f, bool periodic) :
+  ClusterTracker(f, kernel(f.rank()), periodic)
+{
+}
+
+// -------------------------------------------------------------------------------------------------
+
+inline
+ClusterTracker::ClusterTracker(const ArrI &f, const ArrI &kern, bool periodic) :
+  mPeriodic(periodic)
+{
+  // check
+  if ( f.rank() > 3 )
+    throw std::runtime_error("GooseEYE::ClusterTracker - rank of 'f' must be <= 3");
+
+  // shape of the image (3-d)
+  for ( size_t i = 0 ; i < 3 ; ++i ) mShape[i] = 1;
+
+  for ( size_t i = 0 ; i < f.rank() ; ++i ) mShape[i] = f.shape<int>(i);
+
+  // neighbourhood: the backward half of the kernel and its mirror image (see "KernelOffsets")
+  Private::KernelOffsets offsets(kern);
+
+  for ( auto &d : offsets.half() ) mOffsets.push_back( d);
+  for ( auto &d : offsets.half() ) mOffsets.push_back(-d);
+
+  // binary image
+  mImage = ArrI::Zero(f.shape());
+
+  for ( size_t k = 0 ; k < f.size() ; ++k )
+    if ( f[k] )
+      mImage[k] = 1;
+
+  // initial labels
+  mLabels = clusters(mImage, kern, 0, periodic);
+
+  // number of voxels per label
+  mSize.assign(static_cast<size_t>(mLabels.max()) + 1, 0);
+
+  for ( size_t k = 0 ; k < mLabels.size() ; ++k ) mSize[mLabels[k]]++;
+
+  mSize[0] = 0;
+  mCount   = mSize.size() - 1;
+}
+
+// =================================================================================================
+// neighbours of voxel "k" (periodic: across the edges of the image)
+// =================================================================================================
+
+template<class Func>
+inline void ClusterTracker::neighbours(size_t k, Func func) const
+{
+  int x[3] = {
+    static_cast<int>( k / ( mShape[1] * mShape[2] ) ),
+    static_cast<int>( ( k / mShape[2] ) % mShape[1] ),
+    static_cast<int>( k % mShape[2] )
+  };
+
+  for ( size_t n = 0 ; n < mOffsets.size() ; n += 3 ) {
+
+    int  y[3];
+    bool in = true;
+
+    for ( size_t ax = 0 ; ax < 3 ; ++ax ) {
+      y[ax] = x[ax] + mOffsets[n+ax];
+      if      ( mPeriodic ) y[ax] = ( y[ax] % mShape[ax] + mShape[ax] ) % mShape[ax];
+      else if ( y[ax] < 0 or y[ax] >= mShape[ax] ) in = false;
+    }
+
+    if ( in ) func( ( static_cast<size_t>(y[0]) * mShape[1] + y[1] ) * mShape[2] + y[2] );
+  }
+}
+
+// =================================================================================================
+// update to the next image: the voxels that changed
+// =================================================================================================
+
+inline
+VecI ClusterTracker::update(const ArrI &f)
+{
+  // check
+  if ( f.shape() != mImage.shape() )
+    throw std::runtime_error("GooseEYE::ClusterTracker::update - shape inconsistent");
+
+  // changed voxels
+  VecS index;
+  VecI value;
+
+  for ( size_t k = 0 ; k < f.size() ; ++k ) {
+    if ( ( f[k] != 0 ) != ( mImage[k] != 0 ) ) {
+      index.push_back(k);
+      value.push_back(f[k]);
+    }
+  }
+
+  return update(index, value);
+}
+
+// =================================================================================================
+// update: set voxels to a new value, relabel the affected clusters
+// =================================================================================================
+
+inline
+VecI ClusterTracker::update(const VecS &index, const VecI &value)
+{
+  // check
+  if ( index.size() != value.size() )
+    throw std::runtime_error("GooseEYE::ClusterTracker::update - 'index' and 'value' inconsistent");
+
+  for ( auto &k : index )
+    if ( k >= mImage.size() )
+      throw std::runtime_error("GooseEYE::ClusterTracker::update - 'index' out of bounds");
+
+  // raw data (row-major storage)
+  int *F = mImage .data();
+  int *L = mLabels.data();
+
+  // - changed voxels (binary), for a voxel that occurs more than once: the last value
+  std::vector<size_t> order(index.size());
+
+  std::iota(order.begin(), order.end(), 0);
+
+  std::stable_sort(order.begin(), order.end(), [&](size_t a, size_t b) {
+    return index[a] < index[b];
+  });
+
+  std::vector<std::pair<size_t,int>> changed;
+
+  for ( size_t n = 0 ; n < order.size() ; ++n ) {
+    if ( n+1 < order.size() and index[order[n+1]] == index[order[n]] ) continue;
+    size_t k = index[order[n]];
+    int    v = value[order[n]] ? 1 : 0;
+    if ( v != F[k] ) changed.emplace_back(k, v);
+  }
+
+  // - affected clusters: contain a removed voxel, or touch an added voxel (and a voxel of each)
+  std::vector<std::pair<int,size_t>> affected;
+
+  auto affect = [&](size_t k) {
+    if ( L[k] > 0 ) affected.emplace_back(L[k], k);
+  };
+
+  for ( auto &c : changed ) {
+    if ( c.second == 0 ) affect(c.first);
+    else                 neighbours(c.first, affect);
+  }
+
+  std::sort(affected.begin(), affected.end());
+
+  // - collect the voxels of the affected clusters (with their old label), and clear their labels
+  std::vector<std::pair<size_t,int>> region;
+  std::vector<size_t>                stack;
+
+  for ( size_t n = 0 ; n < affected.size() ; ++n ) {
+
+    int lab = affected[n].first;
+
+    if ( n > 0 and affected[n-1].first == lab ) continue;
+
+    stack.push_back(affected[n].second);
+    region.emplace_back(affected[n].second, lab);
+    L[affected[n].second] = 0;
+
+    while ( ! stack.empty() ) {
+      size_t k = stack.back();
+      stack.pop_back();
+      neighbours(k, [&](size_t m) {
+        if ( L[m] != lab ) return;
+        L[m] = 0;
+        region.emplace_back(m, lab);
+        stack.push_back(m);
+      });
+    }
+
+    mSize[lab] = 0;
+    mCount--;
+  }
+
+  // - apply the changes, the added voxels are part of the affected region
+  for ( auto &c : changed ) {
+    F[c.first] = c.second;
+    if ( c.second ) region.emplace_back(c.first, 0);
+  }
+
+  std::sort(region.begin(), region.end());
+
+  // - flood fill the affected region (in raster order), temporarily labelling its voxels "-1"
+  VecI out;
+
+  for ( auto &i : affected ) out.push_back(i.first);
+
+  std::vector<size_t> part;
+
+  for ( auto &r : region ) {
+
+    if ( ! F[r.first] or L[r.first] != 0 ) continue;
+
+    part.assign(1, r.first);
+    stack.assign(1, r.first);
+    L[r.first] = -1;
+
+    while ( ! stack.empty() ) {
+      size_t k = stack.back();
+      stack.pop_back();
+      neighbours(k, [&](size_t m) {
+        if ( ! F[m] or L[m] != 0 ) return;
+        L[m] = -1;
+        part.push_back(m);
+        stack.push_back(m);
+      });
+    }
+
+    // -- label: lowest old label of the part that is not yet taken, or else a new label
+    int lab = 0;
+
+    for ( auto &k : part ) {
+      auto it = std::lower_bound(region.begin(), region.end(), std::make_pair(k, 0));
+      int  old = it->second;
+      if ( old > 0 and mSize[old] == 0 and ( lab == 0 or old < lab ) ) lab = old;
+    }
+
+    if ( lab == 0 ) {
+      lab = static_cast<int>(mSize.size());
+      mSize.push_back(0);
+    }
+
+    for ( auto &k : part ) L[k] = lab;
+
+    mSize[lab] = part.size();
+    mCount++;
+
+    out.push_back(lab);
+  }
+
+  // labels that changed
+  std::sort(out.begin(), out.end());
+
+  out.erase(std::unique(out.begin(), out.end()), out.end());
+
+  return out;
+}
+
+// =================================================================================================
+
+} // namespace ...
+
+// =================================================================================================
+
+#endif
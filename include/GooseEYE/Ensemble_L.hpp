@@ -19,7 +19,7 @@ namespace GooseEYE {
 // lineal path function
 // =================================================================================================
 
-void Ensemble::L(ArrI f, std::string mode)
+void Ensemble::L(ArrI f, std::string mode, bool trie)
 {
   // lock measure
   if ( mStat == Stat::Unset) mStat = Stat::L;
@@ -38,24 +38,85 @@ void Ensemble::L(ArrI f, std::string mode)
   // list of end-points of ROI-stamp used in path-based correlations (make 3-d to simply below)
   MatI stamp = stampPoints(3);
 
-  // correlation
+  // voxel-paths from the origin to each of the end-points (interpret "mode" only once)
+  Path::Value       pmode = pathMode(mode);
+  std::vector<MatI> paths(stamp.shape(0));
+
   for ( size_t ipnt = 0 ; ipnt < stamp.shape(0) ; ++ipnt )
+    paths[ipnt] = path({0,0,0}, {stamp(ipnt,0), stamp(ipnt,1), stamp(ipnt,2)}, pmode);
+
+  // shape of the image
+  int shape[3] = {f.shape<int>(0), f.shape<int>(1), f.shape<int>(2)};
+
+  // raw data (row-major storage): avoids index computations in the inner loop
+  const int *F = f.data();
+  double    *D = mData.data();
+
+  // correlation: walk a prefix-tree of all voxel-paths, skip a subtree as soon as a voxel is not
+  // in the phase (each voxel is tested once for each distinct prefix)
+  if ( trie )
   {
-    // - voxel-path
-    MatI pix = path({0,0,0}, {stamp(ipnt,0), stamp(ipnt,1), stamp(ipnt,2)}, mode);
+    // - all voxel-paths merged, as linear offsets in the image and in the ROI
+    Private::PathTree tree(paths, shape, mShape);
+    // - alias
+    const ptrdiff_t *img = tree.img  ().data();
+    const size_t    *roi = tree.roi  ().data();
+    const size_t    *nxt = tree.next ().data();
+    const double    *cnt = tree.count().data();
+    size_t           n   = tree.size ();
     // - compute correlation
-    for ( int h = mSkip[0] ; h < f.shape<int>(0)-mSkip[0] ; ++h ) {
-      for ( int i = mSkip[1] ; i < f.shape<int>(1)-mSkip[1] ; ++i ) {
-        for ( int j = mSkip[2] ; j < f.shape<int>(2)-mSkip[2] ; ++j ) {
-          for ( size_t ipix = 0 ; ipix < pix.shape(0) ; ++ipix ) {
-            // -- get current voxel
-            int dh = pix(ipix,0);
-            int di = pix(ipix,1);
-            int dj = pix(ipix,2);
-            // -- check to terminate this path
-            if ( ! f(h+dh,i+di,j+dj) ) break;
-            // -- update result
-            mData(dh+mMid[0], di+mMid[1], dj+mMid[2]) += 1.;
+    for ( int h = mSkip[0] ; h < shape[0]-mSkip[0] ; ++h ) {
+      for ( int i = mSkip[1] ; i < shape[1]-mSkip[1] ; ++i ) {
+        for ( int j = mSkip[2] ; j < shape[2]-mSkip[2] ; ++j ) {
+          // -- paths inside the image: proceed by adding offsets to the current voxel
+          if ( tree.interior(h,i,j) ) {
+            const int *fij = F + ( h * shape[1] + i ) * shape[2] + j;
+            for ( size_t k = 0 ; k < n ; ) {
+              if ( fij[img[k]] ) { D[roi[k]] += cnt[k]; ++k;      }
+              else               {                      k = nxt[k]; }
+            }
+          }
+          // -- paths crossing the edge of the (periodic) image
+          else {
+            for ( size_t k = 0 ; k < n ; ) {
+              if ( F[tree.index(k,h,i,j)] ) { D[roi[k]] += cnt[k]; ++k;      }
+              else                          {                      k = nxt[k]; }
+            }
+          }
+        }
+      }
+    }
+  }
+
+  // correlation: walk each voxel-path separately
+  else
+  {
+    for ( auto &p : paths )
+    {
+      // - voxel-path, as linear offsets in the image and in the ROI
+      Private::PathOffsets pix(p, shape, mShape);
+      // - alias
+      const ptrdiff_t *img = pix.img().data();
+      const size_t    *roi = pix.roi().data();
+      // - compute correlation
+      for ( int h = mSkip[0] ; h < shape[0]-mSkip[0] ; ++h ) {
+        for ( int i = mSkip[1] ; i < shape[1]-mSkip[1] ; ++i ) {
+          for ( int j = mSkip[2] ; j < shape[2]-mSkip[2] ; ++j ) {
+            // -- path inside the image: proceed by adding offsets to the current voxel
+            if ( pix.interior(h,i,j) ) {
+              const int *fij = F + ( h * shape[1] + i ) * shape[2] + j;
+              for ( size_t ipix = 0 ; ipix < pix.size() ; ++ipix ) {
+                if ( ! fij[img[ipix]] ) break;
+                D[roi[ipix]] += 1.;
+              }
+            }
+            // -- path crossing the edge of the (periodic) image
+            else {
+              for ( size_t ipix = 0 ; ipix < pix.size() ; ++ipix ) {
+                if ( ! F[pix.index(ipix,h,i,j)] ) break;
+                D[roi[ipix]] += 1.;
+              }
+            }
           }
         }
       }
@@ -63,16 +124,113 @@ void Ensemble::L(ArrI f, std::string mode)
   }
 
   // number of data-points
-  double N = static_cast<double>((f.shape(0)-mSkip[0])*(f.shape(1)-mSkip[1])*(f.shape(2)-mSkip[2]));
+  double N = static_cast<double>(
+    (shape[0]-2*mSkip[0]) * (shape[1]-2*mSkip[1]) * (shape[2]-2*mSkip[2]) );
 
   // normalization
-  for ( size_t ipnt = 0 ; ipnt < stamp.shape(0) ; ++ipnt )
-  {
-    // - voxel-path
-    MatI pix = path({0,0,0}, {stamp(ipnt,0), stamp(ipnt,1), stamp(ipnt,2)}, mode);
-    // - loop over voxel-path
+  for ( auto &pix : paths )
     for ( size_t ipix = 0 ; ipix < pix.shape(0) ; ++ipix )
       mNorm(pix(ipix,0)+mMid[0],pix(ipix,1)+mMid[1],pix(ipix,2)+mMid[2]) += N;
+}
+
+// =================================================================================================
+// lineal path function along a lattice direction: from the run-lengths along each line
+// =================================================================================================
+
+void Ensemble::L_direction(ArrI f, VecI direction)
+{
+  // lock measure
+  if ( mStat == Stat::Unset) mStat = Stat::L;
+
+  // checks
+  std::string name = "GooseEYE::Ensemble::L_direction - ";
+  if ( f.rank()         != mData.rank() ) throw std::runtime_error(name+"rank inconsistent");
+  if ( direction.size() != mData.rank() ) throw std::runtime_error(name+"rank inconsistent");
+  if ( mStat            != Stat::L      ) throw std::runtime_error(name+"statistics cannot be mixed");
+
+  // check direction: along an axis or a diagonal
+  for ( auto &i : direction )
+    if ( i < -1 or i > 1 )
+      throw std::runtime_error(name+"'direction' must be -1, 0, or +1 along each axis");
+
+  if ( std::all_of(direction.begin(), direction.end(), [](int i){ return i == 0; }) )
+    throw std::runtime_error(name+"'direction' must be non-zero");
+
+  // change rank (to simplify below)
+  f.chrank(3);
+
+  // shape of the image, and direction (make 3-d to simplify below)
+  int shape[3] = {f.shape<int>(0), f.shape<int>(1), f.shape<int>(2)};
+  int dx   [3] = {0, 0, 0};
+
+  for ( size_t i = 0 ; i < direction.size() ; ++i ) dx[i] = direction[i];
+
+  // number of steps along "direction" that fit in the ROI
+  int n = std::numeric_limits<int>::max();
+
+  for ( size_t i = 0 ; i < MAX_DIM ; ++i )
+    if ( dx[i] )
+      n = std::min(n, mMid[i]);
+
+  // run-length from which all distances are in the phase
+  size_t cap = static_cast<size_t>(n+1);
+
+  // number of start-voxels from which the phase extends over (at least) "r" voxels
+  // in positive and in negative direction
+  std::vector<double> pos(cap+1, 0.);
+  std::vector<double> neg(cap+1, 0.);
+
+  // raw data (row-major storage)
+  const int *F = f.data();
+
+  // check if a voxel is a start-voxel (only relevant for non-periodic images)
+  auto start = [&](size_t k) {
+    int h = static_cast<int>( k / ( static_cast<size_t>(shape[1]) * shape[2] ) );
+    int i = static_cast<int>( ( k / shape[2] ) % shape[1] );
+    int j = static_cast<int>( k % shape[2] );
+    return h >= mSkip[0] and h < shape[0]-mSkip[0] and
+           i >= mSkip[1] and i < shape[1]-mSkip[1] and
+           j >= mSkip[2] and j < shape[2]-mSkip[2];
+  };
+
+  // run-length encoding of each line along "direction" (scans each voxel once)
+  std::vector<Private::Run> runs;
+
+  Private::lines(shape, dx, mPeriodic, [&](const std::vector<size_t> &line, bool cyclic)
+  {
+    // - runs of voxels in the phase
+    bool ring = Private::runs(line, cyclic, [F](size_t k){ return F[k] != 0; }, runs);
+
+    // - the phase extends over "length-m" voxels in positive direction, and over "m+1" voxels
+    //   in negative direction, from the "m"-th voxel in the run
+    for ( auto &run : runs ) {
+      for ( size_t m = 0 ; m < run.length ; ++m ) {
+        if ( mPeriodic or start(line[(run.begin+m)%line.size()]) ) {
+          pos[ ring ? cap : std::min(run.length-m, cap) ] += 1.;
+          neg[ ring ? cap : std::min(m+1         , cap) ] += 1.;
+        }
+      }
+    }
+  });
+
+  // number of data-points
+  double N = static_cast<double>(
+    (shape[0]-2*mSkip[0]) * (shape[1]-2*mSkip[1]) * (shape[2]-2*mSkip[2]) );
+
+  // correlation and normalization: a distance of "k" steps is in the phase for all start-voxels
+  // from which the phase extends over more than "k" voxels
+  double cpos = 0.;
+  double cneg = 0.;
+
+  for ( int k = n ; k >= 0 ; --k )
+  {
+    cpos += pos[k+1];
+    cneg += neg[k+1];
+
+    mData(mMid[0]+k*dx[0], mMid[1]+k*dx[1], mMid[2]+k*dx[2]) += cpos;
+    mData(mMid[0]-k*dx[0], mMid[1]-k*dx[1], mMid[2]-k*dx[2]) += cneg;
+    mNorm(mMid[0]+k*dx[0], mMid[1]+k*dx[1], mMid[2]+k*dx[2]) += N;
+    mNorm(mMid[0]-k*dx[0], mMid[1]-k*dx[1], mMid[2]-k*dx[2]) += N;
   }
 }
 
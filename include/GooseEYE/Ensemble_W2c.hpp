@@ -16,10 +16,12 @@
 namespace GooseEYE {
 
 // =================================================================================================
-// weighted 2-point correlation collapsed to cluster centres -- "master"
+// weighted 2-point correlation collapsed to cluster centres -- "master": compact list of centres
 // =================================================================================================
 
-void Ensemble::W2c(ArrI clus, ArrI cntr, ArrD f, ArrI fmask, std::string mode)
+template<class T>
+void Ensemble::W2c_list(const cppmat::array<T> &clus, const std::vector<int> &list, ArrD f,
+  ArrI fmask, std::string mode, size_t nthreads)
 {
   // lock measure
   if ( mStat == Stat::Unset) mStat = Stat::W2c;
@@ -29,13 +31,6 @@ void Ensemble::W2c(ArrI clus, ArrI cntr, ArrD f, ArrI fmask, std::string mode)
   if ( f.rank()  != mData.rank()  ) throw std::runtime_error(name+"rank inconsistent");
   if ( f.shape() != fmask.shape() ) throw std::runtime_error(name+"shape inconsistent");
   if ( f.shape() != clus .shape() ) throw std::runtime_error(name+"shape inconsistent");
-  if ( f.shape() != cntr .shape() ) throw std::runtime_error(name+"shape inconsistent");
-
-  // switch off bound-checks based on periodicity settings
-  clus .setPeriodic(mPeriodic);
-  cntr .setPeriodic(mPeriodic);
-  f    .setPeriodic(mPeriodic);
-  fmask.setPeriodic(mPeriodic);
 
   // change rank (to avoid failing assertions)
   f.chrank(3);
@@ -43,46 +38,115 @@ void Ensemble::W2c(ArrI clus, ArrI cntr, ArrD f, ArrI fmask, std::string mode)
   // list of end-points of ROI-stamp used in path-based correlations (make 3-d to simply below)
   MatI stamp = stampPoints(3);
 
-  // correlation
+  // shape of the image
+  int shape[3] = {f.shape<int>(0), f.shape<int>(1), f.shape<int>(2)};
+
+  // raw data (row-major storage): avoids index computations in the inner loop
+  const T      *C = clus .data();
+  const double *F = f    .data();
+  const int    *M = fmask.data();
+
+  // voxel-paths, as linear offsets in the image and in the ROI (interpret "mode" only once)
+  Path::Value                       pmode = pathMode(mode);
+  std::vector<Private::PathOffsets> paths;
+
   for ( size_t ipnt = 0 ; ipnt < stamp.shape(0) ; ++ipnt )
+    paths.emplace_back(
+      path({0,0,0}, {stamp(ipnt,0), stamp(ipnt,1), stamp(ipnt,2)}, pmode), shape, mShape);
+
+  // cluster centres that are not skipped: [ [label, h, i, j], ... ]
+  std::vector<int> centres;
+
+  for ( size_t icntr = 0 ; icntr < list.size() / 4 ; ++icntr ) {
+    int h = list[4*icntr+1];
+    int i = list[4*icntr+2];
+    int j = list[4*icntr+3];
+    if ( h >= mSkip[0] and h < shape[0]-mSkip[0] and
+         i >= mSkip[1] and i < shape[1]-mSkip[1] and
+         j >= mSkip[2] and j < shape[2]-mSkip[2] )
+      centres.insert(centres.end(), list.begin()+4*icntr, list.begin()+4*icntr+4);
+  }
+
+  // correlation of the "icntr"-th centre, along the voxel-paths "[p0, p1)", added to "D" and "N"
+  auto correlate = [&](size_t icntr, size_t p0, size_t p1, double *D, double *N)
   {
-    // - voxel-path
-    MatI pix = path({0,0,0}, {stamp(ipnt,0), stamp(ipnt,1), stamp(ipnt,2)}, mode);
-    // - compute correlation
-    for ( int h = mSkip[0] ; h < f.shape<int>(0)-mSkip[0] ; ++h ) {
-      for ( int i = mSkip[1] ; i < f.shape<int>(1)-mSkip[1] ; ++i ) {
-        for ( int j = mSkip[2] ; j < f.shape<int>(2)-mSkip[2] ; ++j ) {
-          // -- use clusters centres as binary weight (skip zero weight)
-          if ( cntr(h,i,j) ) {
-            // -- store label
-            int label = cntr(h,i,j);
-            // -- proceed only when the centre is inside the cluster
-            if ( clus(h,i,j) == label ) {
-              // -- initialize counter
-              int jpix = -1;
-              // -- loop through the voxel-path
-              for ( size_t ipix = 0 ; ipix < pix.shape(0) ; ++ipix ) {
-                // -- get current voxel
-                int dh = pix(ipix,0);
-                int di = pix(ipix,1);
-                int dj = pix(ipix,2);
-                // -- loop through the voxel-path until the end of a cluster
-                if ( clus(h+dh,i+di,j+dj) != label and jpix < 0 ) jpix = 0;
-                // -- store: loop from the beginning of the path and store there
-                if ( jpix >= 0 ) {
-                  if ( ! fmask(h+dh,i+di,j+dj) ) {
-                    mNorm(mMid[0]+pix(jpix,0),mMid[1]+pix(jpix,1),mMid[1]+pix(jpix,2)) += 1.;
-                    mData(mMid[0]+pix(jpix,0),mMid[1]+pix(jpix,1),mMid[1]+pix(jpix,2)) += f(h+dh,i+di,j+dj);
-                  }
-                }
-                // -- update counter
-                jpix++;
-              }
-            }
+    // - position and linear index of the centre
+    int    h   = centres[4*icntr+1];
+    int    i   = centres[4*icntr+2];
+    int    j   = centres[4*icntr+3];
+    size_t idx = ( static_cast<size_t>(h) * shape[1] + i ) * shape[2] + j;
+    // - store label
+    T label = static_cast<T>(centres[4*icntr+0]);
+    // - loop over voxel-paths
+    for ( size_t p = p0 ; p < p1 ; ++p )
+    {
+      // -- alias
+      const Private::PathOffsets &pix = paths[p];
+      const ptrdiff_t            *img = pix.img().data();
+      const size_t               *roi = pix.roi().data();
+      // -- path inside the image: proceed by adding offsets to the centre
+      bool interior = pix.interior(h,i,j);
+      // -- initialize counter
+      int jpix = -1;
+      // -- loop through the voxel-path
+      for ( size_t ipix = 0 ; ipix < pix.size() ; ++ipix ) {
+        // -- get current voxel
+        size_t k = interior ? idx + img[ipix] : pix.index(ipix,h,i,j);
+        // -- loop through the voxel-path until the end of a cluster
+        if ( C[k] != label and jpix < 0 ) jpix = 0;
+        // -- store: loop from the beginning of the path and store there
+        if ( jpix >= 0 ) {
+          if ( ! M[k] ) {
+            N[roi[jpix]] += 1.;
+            D[roi[jpix]] += F[k];
           }
         }
+        // -- update counter
+        jpix++;
       }
     }
+  };
+
+  // number of centres and of voxel-paths
+  size_t ncntr  = centres.size() / 4;
+  size_t npaths = paths.size();
+
+  // number of threads ("0" -> all available), not more than the number of centres
+  nthreads = std::min(Private::threads(nthreads), std::max(ncntr, static_cast<size_t>(1)));
+
+  // serial: loop over cluster centres, and then over all voxel-paths
+  if ( nthreads == 1 )
+  {
+    for ( size_t icntr = 0 ; icntr < ncntr ; ++icntr )
+      correlate(icntr, 0, npaths, mData.data(), mNorm.data());
+
+    return;
+  }
+
+  // parallel: tasks of one centre and a chunk of the voxel-paths, such that there are enough tasks
+  // to balance large and small clusters (also if there are only a few centres)
+  size_t nchunk = std::max(static_cast<size_t>(1), ( 16 * nthreads + ncntr - 1 ) / ncntr);
+  nchunk        = std::min(nchunk, npaths);
+  size_t lchunk = ( npaths + nchunk - 1 ) / nchunk;
+
+  // - private accumulators of each thread
+  std::vector<std::vector<double>> data(nthreads, std::vector<double>(mData.size(), 0.));
+  std::vector<std::vector<double>> norm(nthreads, std::vector<double>(mNorm.size(), 0.));
+
+  // - compute
+  Private::parallel_for(ncntr*nchunk, nthreads, [&](size_t itask, size_t ithread) {
+    size_t icntr = itask / nchunk;
+    size_t p0    = ( itask % nchunk ) * lchunk;
+    size_t p1    = std::min(p0 + lchunk, npaths);
+    correlate(icntr, p0, p1, data[ithread].data(), norm[ithread].data());
+  });
+
+  // - reduce
+  for ( size_t ithread = 0 ; ithread < nthreads ; ++ithread ) {
+    for ( size_t k = 0 ; k < mData.size() ; ++k ) {
+      mData[k] += data[ithread][k];
+      mNorm[k] += norm[ithread][k];
+    }
   }
 }
 
@@ -90,253 +154,140 @@ void Ensemble::W2c(ArrI clus, ArrI cntr, ArrD f, ArrI fmask, std::string mode)
 // weighted 2-point correlation collapsed to cluster centres -- "slave": compare to "master"
 // =================================================================================================
 
-void Ensemble::W2c(ArrI clus, ArrI cntr, ArrI f, ArrI fmask, std::string mode)
+void Ensemble::W2c(ArrI clus, ArrI cntr, ArrD f, ArrI fmask, std::string mode, size_t nthreads)
 {
-  // lock measure
-  if ( mStat == Stat::Unset) mStat = Stat::W2c;
+  // check
+  if ( clus.shape() != cntr.shape() )
+    throw std::runtime_error("GooseEYE::Ensemble::W2c - shape inconsistent");
 
-  // checks
-  std::string name = "GooseEYE::Ensemble::W2c - ";
-  if ( f.rank()  != mData.rank()  ) throw std::runtime_error(name+"rank inconsistent");
-  if ( f.shape() != fmask.shape() ) throw std::runtime_error(name+"shape inconsistent");
-  if ( f.shape() != clus .shape() ) throw std::runtime_error(name+"shape inconsistent");
-  if ( f.shape() != cntr .shape() ) throw std::runtime_error(name+"shape inconsistent");
-
-  // switch off bound-checks based on periodicity settings
-  clus .setPeriodic(mPeriodic);
-  cntr .setPeriodic(mPeriodic);
-  f    .setPeriodic(mPeriodic);
-  fmask.setPeriodic(mPeriodic);
-
-  // change rank (to avoid failing assertions)
-  f.chrank(3);
-
-  // list of end-points of ROI-stamp used in path-based correlations (make 3-d to simply below)
-  MatI stamp = stampPoints(3);
-
-  // correlation
-  for ( size_t ipnt = 0 ; ipnt < stamp.shape(0) ; ++ipnt )
-  {
-    // - voxel-path
-    MatI pix = path({0,0,0}, {stamp(ipnt,0), stamp(ipnt,1), stamp(ipnt,2)}, mode);
-    // - compute correlation
-    for ( int h = mSkip[0] ; h < f.shape<int>(0)-mSkip[0] ; ++h ) {
-      for ( int i = mSkip[1] ; i < f.shape<int>(1)-mSkip[1] ; ++i ) {
-        for ( int j = mSkip[2] ; j < f.shape<int>(2)-mSkip[2] ; ++j ) {
-          // -- use clusters centres as binary weight (skip zero weight)
-          if ( cntr(h,i,j) ) {
-            // -- store label
-            int label = cntr(h,i,j);
-            // -- proceed only when the centre is inside the cluster
-            if ( clus(h,i,j) == label ) {
-              // -- initialize counter
-              int jpix = -1;
-              // -- loop through the voxel-path
-              for ( size_t ipix = 0 ; ipix < pix.shape(0) ; ++ipix ) {
-                // -- get current voxel
-                int dh = pix(ipix,0);
-                int di = pix(ipix,1);
-                int dj = pix(ipix,2);
-                // -- loop through the voxel-path until the end of a cluster
-                if ( clus(h+dh,i+di,j+dj) != label and jpix < 0 ) jpix = 0;
-                // -- store: loop from the beginning of the path and store there
-                if ( jpix >= 0 ) {
-                  if ( ! fmask(h+dh,i+di,j+dj) ) {
-                    mNorm(mMid[0]+pix(jpix,0),mMid[1]+pix(jpix,1),mMid[1]+pix(jpix,2)) += 1.;
-                    if ( f(h+dh,i+di,j+dj) )
-                      mData(mMid[0]+pix(jpix,0),mMid[1]+pix(jpix,1),mMid[1]+pix(jpix,2)) += 1.;
-                  }
-                }
-                // -- update counter
-                jpix++;
-              }
-            }
-          }
-        }
-      }
-    }
-  }
+  W2c_list(clus, Private::centreList(clus, cntr), f, fmask, mode, nthreads);
 }
 
 // =================================================================================================
 // weighted 2-point correlation collapsed to cluster centres -- "slave": compare to "master"
 // =================================================================================================
 
-void Ensemble::W2c(ArrI clus, ArrI cntr, ArrD f, std::string mode)
+void Ensemble::W2c(ArrI clus, ArrI cntr, ArrI f, ArrI fmask, std::string mode, size_t nthreads)
 {
-  // lock measure
-  if ( mStat == Stat::Unset) mStat = Stat::W2c;
-
-  // checks
-  std::string name = "GooseEYE::Ensemble::W2c - ";
-  if ( f.rank()  != mData.rank()  ) throw std::runtime_error(name+"rank inconsistent");
-  if ( f.shape() != clus .shape() ) throw std::runtime_error(name+"shape inconsistent");
-  if ( f.shape() != cntr .shape() ) throw std::runtime_error(name+"shape inconsistent");
+  // binary image, as floating point
+  ArrD g = ArrD::Zero(f.shape());
 
-  // switch off bound-checks based on periodicity settings
-  clus .setPeriodic(mPeriodic);
-  cntr .setPeriodic(mPeriodic);
-  f    .setPeriodic(mPeriodic);
+  for ( size_t i = 0 ; i < f.size() ; ++i )
+    if ( f[i] )
+      g[i] = 1.;
 
-  // change rank (to avoid failing assertions)
-  f.chrank(3);
+  W2c(clus, cntr, g, fmask, mode, nthreads);
+}
 
-  // list of end-points of ROI-stamp used in path-based correlations (make 3-d to simply below)
-  MatI stamp = stampPoints(3);
+// =================================================================================================
+// weighted 2-point correlation collapsed to cluster centres -- "slave": compare to "master"
+// =================================================================================================
 
-  // correlation
-  for ( size_t ipnt = 0 ; ipnt < stamp.shape(0) ; ++ipnt )
-  {
-    // - voxel-path
-    MatI pix = path({0,0,0}, {stamp(ipnt,0), stamp(ipnt,1), stamp(ipnt,2)}, mode);
-    // - compute correlation
-    for ( int h = mSkip[0] ; h < f.shape<int>(0)-mSkip[0] ; ++h ) {
-      for ( int i = mSkip[1] ; i < f.shape<int>(1)-mSkip[1] ; ++i ) {
-        for ( int j = mSkip[2] ; j < f.shape<int>(2)-mSkip[2] ; ++j ) {
-          // -- use clusters centres as binary weight (skip zero weight)
-          if ( cntr(h,i,j) ) {
-            // -- store label
-            int label = cntr(h,i,j);
-            // -- proceed only when the centre is inside the cluster
-            if ( clus(h,i,j) == label ) {
-              // -- initialize counter
-              int jpix = -1;
-              // -- loop through the voxel-path
-              for ( size_t ipix = 0 ; ipix < pix.shape(0) ; ++ipix ) {
-                // -- get current voxel
-                int dh = pix(ipix,0);
-                int di = pix(ipix,1);
-                int dj = pix(ipix,2);
-                // -- loop through the voxel-path until the end of a cluster
-                if ( clus(h+dh,i+di,j+dj) != label and jpix < 0 ) jpix = 0;
-                // -- store: loop from the beginning of the path and store there
-                if ( jpix >= 0 ) {
-                  mNorm(mMid[0]+pix(jpix,0),mMid[1]+pix(jpix,1),mMid[1]+pix(jpix,2)) += 1.;
-                  mData(mMid[0]+pix(jpix,0),mMid[1]+pix(jpix,1),mMid[1]+pix(jpix,2)) += f(h+dh,i+di,j+dj);
-                }
-                // -- update counter
-                jpix++;
-              }
-            }
-          }
-        }
-      }
-    }
-  }
+void Ensemble::W2c(ArrI clus, ArrI cntr, ArrD f, std::string mode, size_t nthreads)
+{
+  W2c(clus, cntr, f, ArrI::Zero(f.shape()), mode, nthreads);
 }
 
 // =================================================================================================
 // weighted 2-point correlation collapsed to cluster centres -- "slave": compare to "master"
 // =================================================================================================
 
-void Ensemble::W2c(ArrI clus, ArrI cntr, ArrI f, std::string mode)
+void Ensemble::W2c(ArrI clus, ArrI cntr, ArrI f, std::string mode, size_t nthreads)
 {
-  // lock measure
-  if ( mStat == Stat::Unset) mStat = Stat::W2c;
+  W2c(clus, cntr, f, ArrI::Zero(f.shape()), mode, nthreads);
+}
 
-  // checks
-  std::string name = "GooseEYE::Ensemble::W2c - ";
-  if ( f.rank()  != mData.rank()  ) throw std::runtime_error(name+"rank inconsistent");
-  if ( f.shape() != clus .shape() ) throw std::runtime_error(name+"shape inconsistent");
-  if ( f.shape() != cntr .shape() ) throw std::runtime_error(name+"shape inconsistent");
+// =================================================================================================
+// weighted 2-point correlation collapsed to cluster centres -- precomputed clusters
+// =================================================================================================
 
-  // switch off bound-checks based on periodicity settings
-  clus .setPeriodic(mPeriodic);
-  cntr .setPeriodic(mPeriodic);
-  f    .setPeriodic(mPeriodic);
+void Ensemble::W2c(const ClusterSet &clus, ArrD f, ArrI fmask, std::string mode, size_t nthreads)
+{
+  // check: the centres are computed with the periodicity of the clusters
+  if ( clus.periodic() != mPeriodic )
+    throw std::runtime_error("GooseEYE::Ensemble::W2c - periodicity inconsistent");
+
+  if ( clus.labelBits() == 16 )
+    W2c_list(clus.labels16(), clus.centreList3d(), f, fmask, mode, nthreads);
+  else
+    W2c_list(clus.labels32(), clus.centreList3d(), f, fmask, mode, nthreads);
+}
 
-  // change rank (to avoid failing assertions)
-  f.chrank(3);
+// -------------------------------------------------------------------------------------------------
 
-  // list of end-points of ROI-stamp used in path-based correlations (make 3-d to simply below)
-  MatI stamp = stampPoints(3);
+void Ensemble::W2c(const ClusterSet &clus, ArrI f, ArrI fmask, std::string mode, size_t nthreads)
+{
+  // binary image, as floating point
+  ArrD g = ArrD::Zero(f.shape());
 
-  // correlation
-  for ( size_t ipnt = 0 ; ipnt < stamp.shape(0) ; ++ipnt )
-  {
-    // - voxel-path
-    MatI pix = path({0,0,0}, {stamp(ipnt,0), stamp(ipnt,1), stamp(ipnt,2)}, mode);
-    // - compute correlation
-    for ( int h = mSkip[0] ; h < f.shape<int>(0)-mSkip[0] ; ++h ) {
-      for ( int i = mSkip[1] ; i < f.shape<int>(1)-mSkip[1] ; ++i ) {
-        for ( int j = mSkip[2] ; j < f.shape<int>(2)-mSkip[2] ; ++j ) {
-          // -- use clusters centres as binary weight (skip zero weight)
-          if ( cntr(h,i,j) ) {
-            // -- store label
-            int label = cntr(h,i,j);
-            // -- proceed only when the centre is inside the cluster
-            if ( clus(h,i,j) == label ) {
-              // -- initialize counter
-              int jpix = -1;
-              // -- loop through the voxel-path
-              for ( size_t ipix = 0 ; ipix < pix.shape(0) ; ++ipix ) {
-                // -- get current voxel
-                int dh = pix(ipix,0);
-                int di = pix(ipix,1);
-                int dj = pix(ipix,2);
-                // -- loop through the voxel-path until the end of a cluster
-                if ( clus(h+dh,i+di,j+dj) != label and jpix < 0 ) jpix = 0;
-                // -- store: loop from the beginning of the path and store there
-                if ( jpix >= 0 ) {
-                  mNorm(mMid[0]+pix(jpix,0),mMid[1]+pix(jpix,1),mMid[1]+pix(jpix,2)) += 1.;
-                  if ( f(h+dh,i+di,j+dj) )
-                    mData(mMid[0]+pix(jpix,0),mMid[1]+pix(jpix,1),mMid[1]+pix(jpix,2)) += 1.;
-                }
-                // -- update counter
-                jpix++;
-              }
-            }
-          }
-        }
-      }
-    }
-  }
+  for ( size_t i = 0 ; i < f.size() ; ++i )
+    if ( f[i] )
+      g[i] = 1.;
+
+  W2c(clus, g, fmask, mode, nthreads);
 }
 
-// =================================================================================================
-// wrapper functions
-// =================================================================================================
+// -------------------------------------------------------------------------------------------------
 
-void Ensemble::W2c_auto(ArrI w, ArrI f, std::string mode)
+void Ensemble::W2c(const ClusterSet &clus, ArrD f, std::string mode, size_t nthreads)
 {
-  ArrI clus, cntr;
+  W2c(clus, f, ArrI::Zero(f.shape()), mode, nthreads);
+}
 
-  std::tie(clus, cntr) = clusterCenters(w, mPeriodic);
+// -------------------------------------------------------------------------------------------------
 
-  W2c(clus, cntr, f, mode);
+void Ensemble::W2c(const ClusterSet &clus, ArrI f, std::string mode, size_t nthreads)
+{
+  W2c(clus, f, ArrI::Zero(f.shape()), mode, nthreads);
 }
 
-// -------------------------------------------------------------------------------------------------
+// =================================================================================================
+// clusters of the weight image "w": computed only if "w" differs from the previous call
+// =================================================================================================
 
-void Ensemble::W2c_auto(ArrI w, ArrI f, ArrI fmask, std::string mode)
+const ClusterSet& Ensemble::cachedClusters(const ArrI &w, size_t nthreads)
 {
-  ArrI clus, cntr;
+  size_t key = Private::hash(w);
 
-  std::tie(clus, cntr) = clusterCenters(w, mPeriodic);
+  if ( mClusters and key == mClustersHash and w.shape() == mClustersKey.shape() )
+    if ( std::equal(w.data(), w.data()+w.size(), mClustersKey.data()) )
+      return *mClusters;
 
-  W2c(clus, cntr, f, fmask, mode);
+  mClusters     = std::make_shared<ClusterSet>(w, mPeriodic, nthreads);
+  mClustersKey  = w;
+  mClustersHash = key;
+
+  return *mClusters;
 }
 
-// -------------------------------------------------------------------------------------------------
+// =================================================================================================
+// wrapper functions
+// =================================================================================================
 
-void Ensemble::W2c_auto(ArrI w, ArrD f, std::string mode)
+void Ensemble::W2c_auto(ArrI w, ArrI f, std::string mode, size_t nthreads)
 {
-  ArrI clus, cntr;
+  W2c(cachedClusters(w, nthreads), f, mode, nthreads);
+}
 
-  std::tie(clus, cntr) = clusterCenters(w, mPeriodic);
+// -------------------------------------------------------------------------------------------------
 
-  W2c(clus, cntr, f, mode);
+void Ensemble::W2c_auto(ArrI w, ArrI f, ArrI fmask, std::string mode, size_t nthreads)
+{
+  W2c(cachedClusters(w, nthreads), f, fmask, mode, nthreads);
 }
 
 // -------------------------------------------------------------------------------------------------
 
-void Ensemble::W2c_auto(ArrI w, ArrD f, ArrI fmask, std::string mode)
+void Ensemble::W2c_auto(ArrI w, ArrD f, std::string mode, size_t nthreads)
 {
-  ArrI clus, cntr;
+  W2c(cachedClusters(w, nthreads), f, mode, nthreads);
+}
 
-  std::tie(clus, cntr) = clusterCenters(w, mPeriodic);
+// -------------------------------------------------------------------------------------------------
 
-  W2c(clus, cntr, f, fmask, mode);
+void Ensemble::W2c_auto(ArrI w, ArrD f, ArrI fmask, std::string mode, size_t nthreads)
+{
+  W2c(cachedClusters(w, nthreads), f, fmask, mode, nthreads);
 }
 
 // =================================================================================================
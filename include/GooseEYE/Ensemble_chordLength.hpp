@@ -0,0 +1,112 @@
+/* =================================================================================================
+
+(c - GPLv3) T.W.J. de Geus (Tom) | tom@geus.me | www.geus.me | github.com/tdegeus/GooseEYE
+
+================================================================================================= */
+
+#ifndef GOOSEEYE_ENSEMBLE_CHORDLENGTH_HPP
+#define GOOSEEYE_ENSEMBLE_CHORDLENGTH_HPP
+
+// =================================================================================================
+
+#include "GooseEYE.h"
+
+// =================================================================================================
+
+namespace GooseEYE {
+
+// =================================================================================================
+// chord-length distribution: from the run-lengths along each line
+// =================================================================================================
+
+void Ensemble::chordLength(ArrI f, VecI direction, int phase)
+{
+  // lock measure, replace the ROI-shaped storage by a histogram (index: chord length)
+  if ( mStat == Stat::Unset )
+  {
+    mStat = Stat::chordLength;
+    mData = ArrD::Zero({1});
+    mNorm = ArrD::Zero({1});
+  }
+
+  // checks
+  std::string name = "GooseEYE::Ensemble::chordLength - ";
+  if ( direction.size() != f.rank()         ) throw std::runtime_error(name+"rank inconsistent");
+  if ( mStat            != Stat::chordLength) throw std::runtime_error(name+"statistics cannot be mixed");
+
+  // check direction: along an axis or a diagonal
+  for ( auto &i : direction )
+    if ( i < -1 or i > 1 )
+      throw std::runtime_error(name+"'direction' must be -1, 0, or +1 along each axis");
+
+  if ( std::all_of(direction.begin(), direction.end(), [](int i){ return i == 0; }) )
+    throw std::runtime_error(name+"'direction' must be non-zero");
+
+  // change rank (to simplify below)
+  f.chrank(3);
+
+  // shape of the image, and direction (make 3-d to simplify below)
+  int shape[3] = {f.shape<int>(0), f.shape<int>(1), f.shape<int>(2)};
+  int dx   [3] = {0, 0, 0};
+
+  for ( size_t i = 0 ; i < direction.size() ; ++i ) dx[i] = direction[i];
+
+  // raw data (row-major storage)
+  const int *F = f.data();
+
+  // number of chords of each length
+  // N.B. for a periodic line that is entirely in the phase, one chord of the line's length is stored
+  // N.B. not periodic: runs that touch an end of the line are cut by the edge of the image, and are
+  //      not chords (their length is unknown)
+  std::vector<double> hist(mData.size(), 0.);
+
+  // run-length encoding of each line along "direction" (scans each voxel once)
+  std::vector<Private::Run> runs;
+
+  Private::lines(shape, dx, mPeriodic, [&](const std::vector<size_t> &line, bool cyclic)
+  {
+    Private::runs(line, cyclic, [F,phase](size_t k){ return F[k] == phase; }, runs);
+
+    for ( auto &run : runs ) {
+      if ( ! cyclic and ( run.begin == 0 or run.begin + run.length == line.size() ) ) continue;
+      if ( run.length >= hist.size() ) hist.resize(run.length+1, 0.);
+      hist[run.length] += 1.;
+    }
+  });
+
+  // extend the histogram if longer chords have been found
+  if ( hist.size() > mData.size() )
+  {
+    ArrD data = ArrD::Zero({hist.size()});
+    ArrD norm = ArrD::Zero({hist.size()});
+
+    for ( size_t i = 0 ; i < mData.size() ; ++i ) {
+      data[i] = mData[i];
+      norm[i] = mNorm[i];
+    }
+
+    mData = data;
+    mNorm = norm;
+  }
+
+  // total number of chords
+  double n = mNorm[0];
+
+  // correlation
+  for ( size_t i = 0 ; i < hist.size() ; ++i ) {
+    mData[i] += hist[i];
+    n        += hist[i];
+  }
+
+  // normalization: the total number of chords
+  for ( size_t i = 0 ; i < mNorm.size() ; ++i )
+    mNorm[i] = n;
+}
+
+// =================================================================================================
+
+} // namespace ...
+
+// =================================================================================================
+
+#endif
@@ -15,6 +15,296 @@
 
 namespace GooseEYE {
 
+namespace Private { struct RunLabels; class OffsetUnionFind; }
+
+// -------------------------------------------------------------------------------------------------
+// Clusters of a binary image and their centres, computed once such that they can be reused (e.g. to
+// compute "W2c" for many images "f" with the same weight image).
+// -------------------------------------------------------------------------------------------------
+
+class ClusterSet
+{
+private:
+
+  VecS                mShape;    // shape of the image
+  bool                mPeriodic=true; // periodicity of the clusters and the centres
+  size_t              mBits=16;  // number of bits of the stored labels (see "labelBits")
+  ArrU16              mLabels16; // cluster labels (shape of the image), if "mBits == 16"
+  ArrU32              mLabels32; // cluster labels (shape of the image), if "mBits == 32"
+  std::vector<size_t> mCentres;  // centre of each cluster: [ [label, linear index], ... ]
+  std::vector<int>    mList;     // compact list of centres: [ [label, h, i, j], ... ]
+  std::vector<int>    mBox;      // bounding box per label: [ [hmin, imin, jmin, hmax, imax, jmax], ...]
+
+public:
+
+  // default constructor
+  ClusterSet() = default;
+
+  // constructor: see "clusterCenters"
+  explicit ClusterSet(const ArrI &f, bool periodic=true, size_t nthreads=1);
+  explicit ClusterSet(const ArrI &f, const ArrI &kern, int min_size=0, bool periodic=true,
+    size_t nthreads=1);
+
+  // number of clusters (excluding the background)
+  size_t size() const;
+
+  // periodicity used to compute the clusters and their centres
+  bool periodic() const { return mPeriodic; }
+
+  // cluster labels, and centres (as image, see "clusterCenters")
+  ArrI labels () const;
+  ArrI centres() const;
+
+  // stored cluster labels: as "uint16_t" if there are less than 65536 labels, or else "uint32_t"
+  size_t        labelBits() const { return mBits;     }
+  const ArrU16& labels16 () const { return mLabels16; }
+  const ArrU32& labels32 () const { return mLabels32; }
+
+  // compact list of centres: [ [label, h, (i, (j))], ... ] (coordinates: rank of the image),
+  // or (3-d) [ [label, h, i, j], ... ]
+  MatI centreList() const;
+  const std::vector<int>& centreList3d() const { return mList; }
+
+  // bounding box of each label: [ [hmin, (imin, (jmin)), hmax, (imax, (jmax))], ... ]
+  MatI boxes() const;
+};
+
+// -------------------------------------------------------------------------------------------------
+// Properties of each cluster of a label image (e.g. from "clusters"), collected in one pass over the
+// image: size, centroid, bounding box, and second (central) moments. Row "ilab" corresponds to label
+// "ilab"; row "0" (the background) is zero. For periodic images, positions are taken relative to the
+// first voxel of each cluster, unwrapped across the edges of the image. The centroid is wrapped into
+// the image, the bounding box is not (it may extend beyond the edges of the image). From a label
+// image the periodic images are not known: the nearest periodic image is used, which assumes that
+// each cluster spans less than half of the image in each direction. "clusterTable" (and
+// "ClusterStream") unwrap the clusters exactly, by linking them across the edges of the image.
+// -------------------------------------------------------------------------------------------------
+
+class ClusterTable
+{
+private:
+
+  friend class ClusterStream;
+  friend ClusterTable clusterTable(const ArrI &f, const ArrI &kern, bool periodic);
+
+  size_t              mRank;     // rank of the image
+  std::vector<int>    mSize;     // number of voxels per label
+  std::vector<double> mCentroid; // centroid per label: [ [h, i, j], ... ]
+  std::vector<int>    mBox;      // bounding box per label: [ [hmin, ..., jmax], ... ]
+  std::vector<double> mMoment;   // second central moments per label: [ [hh, hi, ..., jj], ... ]
+
+  // collect the sums from a label image; "clus" and "image": cluster of each label and its
+  // periodic image (in multiples of the shape), otherwise the nearest periodic image is used
+  void measure(const ArrI &labels, bool periodic, const std::vector<int> *clus=nullptr,
+    const std::vector<int> *image=nullptr);
+
+  // convert the sums of the positions relative to the reference voxel "ref" of each label
+  void finalize(const int shape[3], bool periodic, const std::vector<int> &ref,
+    const std::vector<int64_t> &s1, const std::vector<int64_t> &s2);
+
+public:
+
+  // default constructor
+  ClusterTable() = default;
+
+  // constructor: labels of each voxel ("0" = background)
+  explicit ClusterTable(const ArrI &labels, bool periodic=true);
+
+  // constructor: labelled runs of a binary image, not linked across the edges (see "clusterTable")
+  explicit ClusterTable(const Private::RunLabels &runs, bool periodic=true);
+
+  // number of clusters (excluding the background)
+  size_t size() const { return mSize.empty() ? 0 : mSize.size() - 1; }
+
+  // number of voxels per label: [ size, ... ]
+  ArrI sizes() const;
+
+  // centroid per label: [ [h, (i, (j))], ... ]
+  MatD centroids() const;
+
+  // bounding box per label: [ [hmin, (imin, (jmin)), hmax, (imax, (jmax))], ... ]
+  MatI boxes() const;
+
+  // second central moments per label: "moments()(ilab,i,j) = < dx_i dx_j >"
+  ArrD moments() const;
+};
+
+// -------------------------------------------------------------------------------------------------
+// Clusters of a binary image that is read slice by slice along its first axis (e.g. a volume that
+// does not fit in memory), labelled as in "clusters" (Hoshen-Kopelman). Only the labels of the
+// previous slice (periodic: also of the first slice) and the sums of the positions of the clusters
+// that intersect it are stored. A cluster is finished as soon as a slice does not intersect it;
+// "pop" returns the clusters finished since its previous call as a "ClusterTable" (row "i" is the
+// "i"-th finished cluster). Periodic: clusters that intersect the first slice are finished only by
+// "close", which merges them with the clusters that they touch across the last slice. The periodic
+// image of each label is tracked across the edges of the image, such that the clusters are
+// unwrapped exactly (as in "clusterTable").
+// -------------------------------------------------------------------------------------------------
+
+class ClusterStream
+{
+private:
+
+  // sums of the positions of the voxels of a cluster, relative to a reference voxel
+  struct Sums
+  {
+    int64_t n;        // number of voxels
+    int     ref[3];   // reference voxel (unwrapped): [h, i, j]
+    int64_t s1[3];    // sum of the relative positions
+    int64_t s2[9];    // sum of the products of the relative positions
+    int     lo[3];    // bounding box: minimum relative position
+    int     hi[3];    // bounding box: maximum relative position
+    int     first;    // periodic: (a) label in the first slice, "0" if not intersecting it
+    int     image[3]; // periodic: periodic image of the label "first" in the cluster
+  };
+
+  size_t            mRank;       // rank of the image (rank of a slice + 1)
+  bool              mPeriodic;   // periodicity (in the slices and along the first axis)
+  bool              mFull;       // full connectivity (otherwise face)
+  bool              mClosed;     // signal that "close" was called
+  int               mShape[3];   // (number of slices read, shape of a slice as 2-d)
+  std::vector<int>  mPrev;       // labels of the previous slice (not linked across its edges)
+  std::vector<int>  mPrevClus;   // cluster of each label of the previous slice (index in "mActive")
+  std::vector<int>  mPrevImage;  // periodic image of each label of the previous slice in its cluster
+  std::vector<int>  mFirst;      // periodic: labels of the first slice (not linked across its edges)
+  std::vector<int>  mFirstClus;  // periodic: cluster (in the first slice) of each label of "mFirst"
+  std::vector<int>  mFirstImage; // periodic: periodic image of each label of "mFirst" in its cluster
+  std::vector<int>  mFirstLinks; // periodic: links between the clusters of the first slice
+  std::vector<int>  mFirstShift; // periodic: periodic image relative to the parent in "mFirstLinks"
+  std::vector<Sums> mActive;     // clusters that intersect the previous slice (index 0 unused)
+  std::vector<Sums> mHeld;       // periodic: finished clusters that intersect the first slice
+  std::vector<Sums> mDone;       // finished clusters, not yet returned by "pop"
+
+  // call "func(q, n)" for each voxel "q" of a neighbouring slice connected to voxel "k" of a slice,
+  // with "n" the number of periods crossed (periodic: across the edges of the slice)
+  template<class Func> void neighbours(size_t k, Func func) const;
+
+  // root cluster in the first slice, and the periodic image of "a" relative to it
+  int firstRoot(int a, int image[3]);
+
+  // add a voxel (unwrapped) to a cluster, merge cluster "b" (in periodic image "shift") into "a"
+  void add(Sums &s, int h, int i, int j) const;
+  void merge(Sums &a, const Sums &b, const int shift[3]);
+
+  // merge the clusters of "mActive" that are linked in "links" into their root
+  void join(Private::OffsetUnionFind &links);
+
+  // store a finished cluster
+  void finish(const Sums &s);
+
+public:
+
+  // constructors: shape of a slice (1-d or 2-d), default kernel (see "kernel") or the default or
+  // "full" kernel of the image
+  ClusterStream() = default;
+  explicit ClusterStream(const VecS &shape, bool periodic=true);
+  ClusterStream(const VecS &shape, const ArrI &kern, bool periodic=true);
+
+  // number of slices read
+  size_t slices() const { return static_cast<size_t>(mShape[0]); }
+
+  // read the next slice (binary)
+  void push(const ArrI &slice);
+
+  // signal the end of the image: all remaining clusters are finished
+  void close();
+
+  // clusters finished since the previous call (as "ClusterTable", row "0" is empty)
+  ClusterTable pop();
+};
+
+// -------------------------------------------------------------------------------------------------
+// Clusters of a binary image that evolves in time (e.g. frames in which only a few voxels change),
+// labelled as in "clusters". "update" relabels only the clusters that contain or touch a changed
+// voxel, by flood filling them again (merges and splits are thus handled locally). A cluster that
+// is not affected keeps its label. An affected cluster takes the lowest label of the clusters it
+// overlaps that is not yet taken (in raster order of the clusters), or else a new label. "update"
+// returns the labels that changed: of clusters that were removed, modified, or created.
+// -------------------------------------------------------------------------------------------------
+
+class ClusterTracker
+{
+private:
+
+  bool                mPeriodic; // periodicity
+  int                 mShape[3]; // shape of the image (3-d)
+  std::vector<int>    mOffsets;  // (symmetric) neighbourhood of the kernel: [ [dh, di, dj], ... ]
+  ArrI                mImage;    // current (binary) image
+  ArrI                mLabels;   // current labels
+  std::vector<size_t> mSize;     // number of voxels per label ("0" = unused label)
+  size_t              mCount;    // number of clusters
+
+  // call "func(n)" for each neighbour "n" of voxel "k" (linear indices)
+  template<class Func> void neighbours(size_t k, Func func) const;
+
+public:
+
+  // constructors: initial image, default kernel (see "kernel") or custom kernel
+  ClusterTracker() = default;
+  explicit ClusterTracker(const ArrI &f, bool periodic=true);
+  ClusterTracker(const ArrI &f, const ArrI &kern, bool periodic=true);
+
+  // update to the next image, or set the voxels "index" (linear indices) to "value"; returns the
+  // labels that changed (sorted)
+  VecI update(const ArrI &f);
+  VecI update(const VecS &index, const VecI &value);
+
+  // current (binary) image, and its labels
+  const ArrI& image () const { return mImage;  }
+  const ArrI& labels() const { return mLabels; }
+
+  // number of clusters, and number of voxels per label ("0" = unused label)
+  size_t size () const { return mCount; }
+  VecS   sizes() const { return mSize;  }
+};
+
+// -------------------------------------------------------------------------------------------------
+// Percolation of the clusters of a binary image (default or "full" kernel), without storing the
+// labels of the voxels: the runs of voxels are labelled (see "clusterTable") and linked across the
+// edges of the image in the same pass. Only the clusters that connect two (or more) faces of the
+// image (not periodic), or that are connected to their own periodic image with a non-zero winding
+// (periodic), are reported; their labels are those of "clusters". A cluster "spans" an axis if it
+// connects both faces normal to the axis (not periodic), or if it wraps along it (periodic).
+// -------------------------------------------------------------------------------------------------
+
+class Percolation
+{
+private:
+
+  size_t              mRank;  // rank of the image
+  size_t              mCount; // number of clusters
+  std::vector<int>    mLabel; // label of each reported cluster
+  std::vector<size_t> mSize;  // number of voxels of each reported cluster
+  std::vector<int>    mFaces; // faces touched (bit "2*ax": lower, "2*ax+1": upper face of axis "ax")
+  std::vector<int>    mSpans; // axes spanned (bit "ax")
+
+public:
+
+  // constructors: default kernel (see "kernel"), or the default or "full" kernel of the image
+  Percolation() = default;
+  explicit Percolation(const ArrI &f, bool periodic=true);
+  Percolation(const ArrI &f, const ArrI &kern, bool periodic=true);
+
+  // number of clusters in the image (excluding the background), number of reported clusters
+  size_t count() const { return mCount;        }
+  size_t size () const { return mLabel.size(); }
+
+  // label and number of voxels of each reported cluster
+  VecI labels() const { return mLabel; }
+  VecS sizes () const { return mSize;  }
+
+  // faces touched by each reported cluster: [ [lower_h, upper_h, (lower_i, upper_i, ...)], ... ]
+  // (not periodic; periodic: zero)
+  MatI faces() const;
+
+  // axes spanned by each reported cluster: [ [h, (i, (j))], ... ]
+  MatI spans() const;
+
+  // check if a cluster spans axis "axis", or any axis
+  bool percolates(size_t axis) const;
+  bool percolates() const;
+};
+
 // -------------------------------------------------------------------------------------------------
 // Class to compute ensemble averaged statistics. Simple front-end functions are provided to compute
 // the statistics on one image.
@@ -34,9 +324,24 @@ private:
   int  mMid[MAX_DIM];     // ROI midpoint along each axis
   int  mSkip[MAX_DIM];    // number of voxels to skip along each axis
   VecS mPad;              // shape with with to pad along each axis
-  bool mPeriodic;         // periodicity settings used for the entire cluster
+  bool mPeriodic=true;    // periodicity settings used for the entire cluster
   int  mStat=Stat::Unset; // used to lock this class to a certain statistic
 
+  // clusters of the last weight image used in "W2c_auto" (reused for the same weight image)
+  std::shared_ptr<ClusterSet> mClusters;
+  ArrI                        mClustersKey;
+  size_t                      mClustersHash=0;
+
+  // clusters of the weight image "w": reuse if "w" is unchanged
+  const ClusterSet& cachedClusters(const ArrI &w, size_t nthreads=1);
+
+  // collapsed weighted 2-point correlation: labels "clus" and compact list of centres
+  // "centres = [ [label, h, i, j], ... ]"
+  // (labels stored as "int", "uint16_t", or "uint32_t")
+  template<class T>
+  void W2c_list(const cppmat::array<T> &clus, const std::vector<int> &centres, ArrD f, ArrI fmask,
+    std::string mode, size_t nthreads);
+
 public:
 
   // default constructor
@@ -72,21 +377,43 @@ public:
 
   // collapsed weighted 2-point correlation
   // mode: "Bresenham", "actual", or "full"
-  void W2c(ArrI clus, ArrI cntr, ArrI f,             std::string mode="Bresenham");
-  void W2c(ArrI clus, ArrI cntr, ArrI f, ArrI fmask, std::string mode="Bresenham");
-  void W2c(ArrI clus, ArrI cntr, ArrD f,             std::string mode="Bresenham");
-  void W2c(ArrI clus, ArrI cntr, ArrD f, ArrI fmask, std::string mode="Bresenham");
+  // nthreads: number of threads to distribute the cluster centres over ("0" -> all available)
+  void W2c(ArrI clus, ArrI cntr, ArrI f,             std::string mode="Bresenham", size_t nthreads=1);
+  void W2c(ArrI clus, ArrI cntr, ArrI f, ArrI fmask, std::string mode="Bresenham", size_t nthreads=1);
+  void W2c(ArrI clus, ArrI cntr, ArrD f,             std::string mode="Bresenham", size_t nthreads=1);
+  void W2c(ArrI clus, ArrI cntr, ArrD f, ArrI fmask, std::string mode="Bresenham", size_t nthreads=1);
+
+  // collapsed weighted 2-point correlation: precomputed clusters and their centres
+  // mode: "Bresenham", "actual", or "full"
+  // nthreads: number of threads to distribute the cluster centres over ("0" -> all available)
+  void W2c(const ClusterSet &clus, ArrI f,             std::string mode="Bresenham", size_t nthreads=1);
+  void W2c(const ClusterSet &clus, ArrI f, ArrI fmask, std::string mode="Bresenham", size_t nthreads=1);
+  void W2c(const ClusterSet &clus, ArrD f,             std::string mode="Bresenham", size_t nthreads=1);
+  void W2c(const ClusterSet &clus, ArrD f, ArrI fmask, std::string mode="Bresenham", size_t nthreads=1);
 
   // collapsed weighted 2-point correlation: automatically compute clusters and their centres
+  // (reused as long as "w" does not change)
   // mode: "Bresenham", "actual", or "full"
-  void W2c_auto(ArrI w, ArrI f,             std::string mode="Bresenham");
-  void W2c_auto(ArrI w, ArrI f, ArrI fmask, std::string mode="Bresenham");
-  void W2c_auto(ArrI w, ArrD f,             std::string mode="Bresenham");
-  void W2c_auto(ArrI w, ArrD f, ArrI fmask, std::string mode="Bresenham");
+  // nthreads: number of threads to distribute the cluster centres over ("0" -> all available)
+  void W2c_auto(ArrI w, ArrI f,             std::string mode="Bresenham", size_t nthreads=1);
+  void W2c_auto(ArrI w, ArrI f, ArrI fmask, std::string mode="Bresenham", size_t nthreads=1);
+  void W2c_auto(ArrI w, ArrD f,             std::string mode="Bresenham", size_t nthreads=1);
+  void W2c_auto(ArrI w, ArrD f, ArrI fmask, std::string mode="Bresenham", size_t nthreads=1);
 
   // lineal path function (binary or int)
   // mode: "Bresenham", "actual", or "full"
-  void L(ArrI f, std::string mode="Bresenham");
+  // trie: walk a prefix-tree of all voxel-paths (same result, faster for large ROIs)
+  void L(ArrI f, std::string mode="Bresenham", bool trie=false);
+
+  // lineal path function (binary or int) along a lattice axis or diagonal only
+  // direction: -1, 0, or +1 along each axis (e.g. {1,0} or {1,1})
+  void L_direction(ArrI f, VecI direction);
+
+  // chord-length distribution of the voxels equal to "phase", along a lattice axis or diagonal
+  // direction: -1, 0, or +1 along each axis (e.g. {1,0} or {1,1})
+  // N.B. the result is a histogram: "result()[n]" is the fraction of chords of length "n"
+  // (the region-of-interest is not used)
+  void chordLength(ArrI f, VecI direction, int phase=1);
 
   // list of end-points of ROI-stamp used in path-based correlations
   MatI stampPoints(size_t nd=0) const; // (nd == 0 -> number of columns is automatic)
@@ -115,35 +442,65 @@ ArrD W2(const VecS &roi, const ArrD &w, const ArrD &f, const ArrI &fmask, bool p
 
 // collapsed weighted 2-point correlation
 // mode: "Bresenham", "actual", or "full"
-ArrD W2c(const VecS &roi, const ArrI &clus, const ArrI &cntr, const ArrI &f,                    bool periodic=true, std::string mode="Bresenham");
-ArrD W2c(const VecS &roi, const ArrI &clus, const ArrI &cntr, const ArrI &f, const ArrI &fmask, bool periodic=true, std::string mode="Bresenham");
-ArrD W2c(const VecS &roi, const ArrI &clus, const ArrI &cntr, const ArrD &f,                    bool periodic=true, std::string mode="Bresenham");
-ArrD W2c(const VecS &roi, const ArrI &clus, const ArrI &cntr, const ArrD &f, const ArrI &fmask, bool periodic=true, std::string mode="Bresenham");
+ArrD W2c(const VecS &roi, const ArrI &clus, const ArrI &cntr, const ArrI &f,                    bool periodic=true, std::string mode="Bresenham", size_t nthreads=1);
+ArrD W2c(const VecS &roi, const ArrI &clus, const ArrI &cntr, const ArrI &f, const ArrI &fmask, bool periodic=true, std::string mode="Bresenham", size_t nthreads=1);
+ArrD W2c(const VecS &roi, const ArrI &clus, const ArrI &cntr, const ArrD &f,                    bool periodic=true, std::string mode="Bresenham", size_t nthreads=1);
+ArrD W2c(const VecS &roi, const ArrI &clus, const ArrI &cntr, const ArrD &f, const ArrI &fmask, bool periodic=true, std::string mode="Bresenham", size_t nthreads=1);
+
+// collapsed weighted 2-point correlation: precomputed clusters and their centres
+// mode: "Bresenham", "actual", or "full"
+ArrD W2c(const VecS &roi, const ClusterSet &clus, const ArrI &f,                    bool periodic=true, std::string mode="Bresenham", size_t nthreads=1);
+ArrD W2c(const VecS &roi, const ClusterSet &clus, const ArrI &f, const ArrI &fmask, bool periodic=true, std::string mode="Bresenham", size_t nthreads=1);
+ArrD W2c(const VecS &roi, const ClusterSet &clus, const ArrD &f,                    bool periodic=true, std::string mode="Bresenham", size_t nthreads=1);
+ArrD W2c(const VecS &roi, const ClusterSet &clus, const ArrD &f, const ArrI &fmask, bool periodic=true, std::string mode="Bresenham", size_t nthreads=1);
 
 // collapsed weighted 2-point correlation: automatically compute clusters and their centres
 // mode: "Bresenham", "actual", or "full"
-ArrD W2c_auto(const VecS &roi, const ArrI &w, const ArrI &f,                    bool periodic=true, std::string mode="Bresenham");
-ArrD W2c_auto(const VecS &roi, const ArrI &w, const ArrI &f, const ArrI &fmask, bool periodic=true, std::string mode="Bresenham");
-ArrD W2c_auto(const VecS &roi, const ArrI &w, const ArrD &f,                    bool periodic=true, std::string mode="Bresenham");
-ArrD W2c_auto(const VecS &roi, const ArrI &w, const ArrD &f, const ArrI &fmask, bool periodic=true, std::string mode="Bresenham");
+ArrD W2c_auto(const VecS &roi, const ArrI &w, const ArrI &f,                    bool periodic=true, std::string mode="Bresenham", size_t nthreads=1);
+ArrD W2c_auto(const VecS &roi, const ArrI &w, const ArrI &f, const ArrI &fmask, bool periodic=true, std::string mode="Bresenham", size_t nthreads=1);
+ArrD W2c_auto(const VecS &roi, const ArrI &w, const ArrD &f,                    bool periodic=true, std::string mode="Bresenham", size_t nthreads=1);
+ArrD W2c_auto(const VecS &roi, const ArrI &w, const ArrD &f, const ArrI &fmask, bool periodic=true, std::string mode="Bresenham", size_t nthreads=1);
 
 // lineal path function (binary or int)
 // mode: "Bresenham", "actual", or "full"
-ArrD L(const VecS &roi, const ArrI &f, bool periodic=true, std::string mode="Bresenham");
+// trie: walk a prefix-tree of all voxel-paths (same result, faster for large ROIs)
+ArrD L(const VecS &roi, const ArrI &f, bool periodic=true, std::string mode="Bresenham",
+  bool trie=false);
+
+// lineal path function (binary or int) along a lattice axis or diagonal only
+// direction: -1, 0, or +1 along each axis (e.g. {1,0} or {1,1})
+ArrD L_direction(const VecS &roi, const ArrI &f, const VecI &direction, bool periodic=true);
+
+// chord-length distribution of the voxels equal to "phase", along a lattice axis or diagonal
+// direction: -1, 0, or +1 along each axis (e.g. {1,0} or {1,1})
+// N.B. the result is a histogram: "result[n]" is the fraction of chords of length "n"
+ArrD chordLength(const ArrI &f, const VecI &direction, int phase=1, bool periodic=true);
 
 // -------------------------------------------------------------------------------------------------
 // miscellaneous functions
 // -------------------------------------------------------------------------------------------------
 
 // clusters of a binary image ("min_size=0": minimum size is ignored)
-ArrI clusters(const ArrI &f,                                   bool periodic=true);
-ArrI clusters(const ArrI &f,                   int min_size  , bool periodic=true);
-ArrI clusters(const ArrI &f, const ArrI &kern, int min_size=0, bool periodic=true);
+// ("nthreads > 1": label in parallel for the default and "full" kernel, identical result)
+ArrI clusters(const ArrI &f,                                   bool periodic=true, size_t nthreads=1);
+ArrI clusters(const ArrI &f,                   int min_size  , bool periodic=true, size_t nthreads=1);
+ArrI clusters(const ArrI &f, const ArrI &kern, int min_size=0, bool periodic=true, size_t nthreads=1);
 
 // clusters and their centers of gravity of a binary image ("min_size=0": minimum size is ignored)
-std::tuple<ArrI,ArrI> clusterCenters(const ArrI &f,                                   bool periodic=true);
-std::tuple<ArrI,ArrI> clusterCenters(const ArrI &f,                   int min_size  , bool periodic=true);
-std::tuple<ArrI,ArrI> clusterCenters(const ArrI &f, const ArrI &kern, int min_size=0, bool periodic=true);
+std::tuple<ArrI,ArrI> clusterCenters(const ArrI &f,                                   bool periodic=true, size_t nthreads=1);
+std::tuple<ArrI,ArrI> clusterCenters(const ArrI &f,                   int min_size  , bool periodic=true, size_t nthreads=1);
+std::tuple<ArrI,ArrI> clusterCenters(const ArrI &f, const ArrI &kern, int min_size=0, bool periodic=true, size_t nthreads=1);
+
+// properties of the clusters of a binary image (as "ClusterTable(clusters(f, kern, 0, periodic))",
+// periodic: unwrapped exactly), for the default and "full" kernel without storing the labels
+ClusterTable clusterTable(const ArrI &f,                   bool periodic=true);
+ClusterTable clusterTable(const ArrI &f, const ArrI &kern, bool periodic=true);
+
+// number of bits needed to store the labels of a (non-negative) label image: 16 or 32
+size_t labelBits(const ArrI &labels);
+
+// label image stored as "uint16_t" or "uint32_t" (throws if the labels do not fit, see "labelBits")
+template<class T> cppmat::array<T> compactLabels(const ArrI &labels);
 
 // dilate image (binary or int)
 // for 'int' image the number of iterations can be specified per label
@@ -152,13 +509,54 @@ ArrI dilate(const ArrI &f                    , const VecS &iterations  , bool pe
 ArrI dilate(const ArrI &f, const ArrI &kernel, size_t      iterations=1, bool periodic=true);
 ArrI dilate(      ArrI  f,       ArrI  kernel, const VecS &iterations  , bool periodic=true);
 
+// Euclidean distance of each voxel to the nearest non-zero voxel (infinite if there is none), exact,
+// in linear time (separable, Felzenszwalb-Huttenlocher)
+ArrD distance(const ArrI &f, bool periodic=true);
+
+// nearest non-zero voxel of each voxel (feature transform): its label and the (Euclidean) distance
+// to it (label "0" and infinite distance if the image has no non-zero voxels)
+std::tuple<ArrI,ArrD> featureTransform(const ArrI &f, bool periodic=true);
+
+// dilate image (binary or int): each voxel takes the label of the nearest non-zero voxel if it is
+// within (Euclidean) distance "radius", which can be specified per label
+// (from "featureTransform": isotropic, and independent of "radius" in cost)
+ArrI dilateRadius(const ArrI &f, double radius                    , bool periodic=true);
+ArrI dilateRadius(const ArrI &f, const std::vector<double> &radius, bool periodic=true);
+
 // kernel
-// mode: "default"
+// mode: "default" (face connectivity: 4 in 2-d, 6 in 3-d), "full" (8 in 2-d, 26 in 3-d)
 ArrI kernel(size_t ndim, std::string mode="default");
 
 // pixel/voxel path between two points "xa" and "xb"
 // mode: "Bresenham", "actual", or "full"
 MatI path(const VecI &xa, const VecI &xb, std::string mode="Bresenham");
+MatI path(const VecI &xa, const VecI &xb, Path::Value mode);
+
+// pixel/voxel paths between many pairs of points "xa(k,:)" and "xb(k,:)"
+// returns the concatenated paths and the offsets: path "k" is "paths[offset[k]:offset[k+1],:]"
+// nthreads: number of threads ("0" -> all available)
+std::tuple<MatI,VecS> paths(const MatI &xa, const MatI &xb, std::string mode="Bresenham",
+  size_t nthreads=1);
+
+// convert path-mode to enumerate (case insensitive): "Bresenham", "actual", or "full"
+Path::Value pathMode(std::string mode);
+
+// pixel/voxel path between two points "xa" and "xb", without allocation (both 3-d: set unused
+// dimensions to zero)
+// - "pathVisit": call "func(const int *x)" for each voxel "x" (3-d) along the path
+// - "pathFill" : write the voxels to "out" ("ndim" per voxel), at most "capacity" voxels;
+//                returns the number of voxels in the path
+template<Path::Value mode, class Func>
+void pathVisit(const int xa[3], const int xb[3], Func func);
+
+template<class Func>
+void pathVisit(Path::Value mode, const int xa[3], const int xb[3], Func func);
+
+template<Path::Value mode>
+size_t pathFill(const int xa[3], const int xb[3], size_t ndim, int *out, size_t capacity);
+
+size_t pathFill(Path::Value mode, const int xa[3], const int xb[3], size_t ndim, int *out,
+  size_t capacity);
 
 // list of end-points of ROI-stamp used in path-based correlations
 MatI stampPoints(const VecS &shape);
@@ -175,10 +573,24 @@ MatI dummy_circles(const VecS &shape, const VecI &row, const VecI &col, const Ve
 
 #include "GooseEYE.hpp"
 #include "dummy_circles.hpp"
+#include "parallel.hpp"
 #include "path.hpp"
+#include "path_offsets.hpp"
+#include "path_tree.hpp"
+#include "runlength.hpp"
+#include "union_find.hpp"
+#include "ccl.hpp"
 #include "kernel.hpp"
+#include "kernel_offsets.hpp"
 #include "clusters.hpp"
+#include "labels.hpp"
+#include "ClusterSet.hpp"
+#include "ClusterTable.hpp"
+#include "ClusterStream.hpp"
+#include "ClusterTracker.hpp"
+#include "Percolation.hpp"
 #include "dilate.hpp"
+#include "distance.hpp"
 #include "Ensemble.hpp"
 #include "Ensemble_stampPoints.hpp"
 #include "Ensemble_mean.hpp"
@@ -186,6 +598,7 @@ MatI dummy_circles(const VecS &shape, const VecI &row, const VecI &col, const Ve
 #include "Ensemble_W2.hpp"
 #include "Ensemble_W2c.hpp"
 #include "Ensemble_L.hpp"
+#include "Ensemble_chordLength.hpp"
 
 // =================================================================================================
 
@@ -167,11 +167,11 @@ ArrD W2(const VecS &roi, const ArrD &w, const ArrD &f, const ArrI &fmask, bool p
 // =================================================================================================
 
 ArrD W2c(const VecS &roi, const ArrI &clus, const ArrI &cntr, const ArrI &f,
-  bool periodic, std::string mode)
+  bool periodic, std::string mode, size_t nthreads)
 {
   Ensemble ensemble(roi, periodic);
 
-  ensemble.W2c(clus, cntr, f, mode);
+  ensemble.W2c(clus, cntr, f, mode, nthreads);
 
   return ensemble.result();
 }
@@ -179,11 +179,11 @@ ArrD W2c(const VecS &roi, const ArrI &clus, const ArrI &cntr, const ArrI &f,
 // -------------------------------------------------------------------------------------------------
 
 ArrD W2c(const VecS &roi, const ArrI &clus, const ArrI &cntr, const ArrI &f, const ArrI &fmask,
-  bool periodic, std::string mode)
+  bool periodic, std::string mode, size_t nthreads)
 {
   Ensemble ensemble(roi, periodic);
 
-  ensemble.W2c(clus, cntr, f, fmask, mode);
+  ensemble.W2c(clus, cntr, f, fmask, mode, nthreads);
 
   return ensemble.result();
 }
@@ -191,11 +191,11 @@ ArrD W2c(const VecS &roi, const ArrI &clus, const ArrI &cntr, const ArrI &f, con
 // -------------------------------------------------------------------------------------------------
 
 ArrD W2c(const VecS &roi, const ArrI &clus, const ArrI &cntr, const ArrD &f,
-  bool periodic, std::string mode)
+  bool periodic, std::string mode, size_t nthreads)
 {
   Ensemble ensemble(roi, periodic);
 
-  ensemble.W2c(clus, cntr, f, mode);
+  ensemble.W2c(clus, cntr, f, mode, nthreads);
 
   return ensemble.result();
 }
@@ -203,11 +203,61 @@ ArrD W2c(const VecS &roi, const ArrI &clus, const ArrI &cntr, const ArrD &f,
 // -------------------------------------------------------------------------------------------------
 
 ArrD W2c(const VecS &roi, const ArrI &clus, const ArrI &cntr, const ArrD &f, const ArrI &fmask,
-  bool periodic, std::string mode)
+  bool periodic, std::string mode, size_t nthreads)
 {
   Ensemble ensemble(roi, periodic);
 
-  ensemble.W2c(clus, cntr, f, fmask, mode);
+  ensemble.W2c(clus, cntr, f, fmask, mode, nthreads);
+
+  return ensemble.result();
+}
+
+// =================================================================================================
+// wrapper functions: collapsed weighted 2-point correlation, precomputed clusters
+// =================================================================================================
+
+ArrD W2c(const VecS &roi, const ClusterSet &clus, const ArrI &f,
+  bool periodic, std::string mode, size_t nthreads)
+{
+  Ensemble ensemble(roi, periodic);
+
+  ensemble.W2c(clus, f, mode, nthreads);
+
+  return ensemble.result();
+}
+
+// -------------------------------------------------------------------------------------------------
+
+ArrD W2c(const VecS &roi, const ClusterSet &clus, const ArrI &f, const ArrI &fmask,
+  bool periodic, std::string mode, size_t nthreads)
+{
+  Ensemble ensemble(roi, periodic);
+
+  ensemble.W2c(clus, f, fmask, mode, nthreads);
+
+  return ensemble.result();
+}
+
+// -------------------------------------------------------------------------------------------------
+
+ArrD W2c(const VecS &roi, const ClusterSet &clus, const ArrD &f,
+  bool periodic, std::string mode, size_t nthreads)
+{
+  Ensemble ensemble(roi, periodic);
+
+  ensemble.W2c(clus, f, mode, nthreads);
+
+  return ensemble.result();
+}
+
+// -------------------------------------------------------------------------------------------------
+
+ArrD W2c(const VecS &roi, const ClusterSet &clus, const ArrD &f, const ArrI &fmask,
+  bool periodic, std::string mode, size_t nthreads)
+{
+  Ensemble ensemble(roi, periodic);
+
+  ensemble.W2c(clus, f, fmask, mode, nthreads);
 
   return ensemble.result();
 }
@@ -217,11 +267,11 @@ ArrD W2c(const VecS &roi, const ArrI &clus, const ArrI &cntr, const ArrD &f, con
 // =================================================================================================
 
 ArrD W2c_auto(const VecS &roi, const ArrI &w, const ArrI &f,
-  bool periodic, std::string mode)
+  bool periodic, std::string mode, size_t nthreads)
 {
   Ensemble ensemble(roi, periodic);
 
-  ensemble.W2c_auto(w, f, mode);
+  ensemble.W2c_auto(w, f, mode, nthreads);
 
   return ensemble.result();
 }
@@ -229,11 +279,11 @@ ArrD W2c_auto(const VecS &roi, const ArrI &w, const ArrI &f,
 // -------------------------------------------------------------------------------------------------
 
 ArrD W2c_auto(const VecS &roi, const ArrI &w, const ArrI &f, const ArrI &fmask,
-  bool periodic, std::string mode)
+  bool periodic, std::string mode, size_t nthreads)
 {
   Ensemble ensemble(roi, periodic);
 
-  ensemble.W2c_auto(w, f, fmask, mode);
+  ensemble.W2c_auto(w, f, fmask, mode, nthreads);
 
   return ensemble.result();
 }
@@ -241,11 +291,11 @@ ArrD W2c_auto(const VecS &roi, const ArrI &w, const ArrI &f, const ArrI &fmask,
 // -------------------------------------------------------------------------------------------------
 
 ArrD W2c_auto(const VecS &roi, const ArrI &w, const ArrD &f,
-  bool periodic, std::string mode)
+  bool periodic, std::string mode, size_t nthreads)
 {
   Ensemble ensemble(roi, periodic);
 
-  ensemble.W2c_auto(w, f, mode);
+  ensemble.W2c_auto(w, f, mode, nthreads);
 
   return ensemble.result();
 }
@@ -253,12 +303,11 @@ ArrD W2c_auto(const VecS &roi, const ArrI &w, const ArrD &f,
 // -------------------------------------------------------------------------------------------------
 
 ArrD W2c_auto(const VecS &roi, const ArrI &w, const ArrD &f, const ArrI &fmask,
-  bool periodic, std::string mode)
-
+  bool periodic, std::string mode, size_t nthreads)
 {
   Ensemble ensemble(roi, periodic);
 
-  ensemble.W2c_auto(w, f, fmask, mode);
+  ensemble.W2c_auto(w, f, fmask, mode, nthreads);
 
   return ensemble.result();
 }
@@ -267,11 +316,35 @@ ArrD W2c_auto(const VecS &roi, const ArrI &w, const ArrD &f, const ArrI &fmask,
 // wrapper functions: lineal path function
 // =================================================================================================
 
-ArrD L(const VecS &roi, const ArrI &f, bool periodic, std::string mode)
+ArrD L(const VecS &roi, const ArrI &f, bool periodic, std::string mode, bool trie)
+{
+  Ensemble ensemble(roi, periodic);
+
+  ensemble.L(f, mode, trie);
+
+  return ensemble.result();
+}
+
+// -------------------------------------------------------------------------------------------------
+
+ArrD L_direction(const VecS &roi, const ArrI &f, const VecI &direction, bool periodic)
 {
   Ensemble ensemble(roi, periodic);
 
-  ensemble.L(f, mode);
+  ensemble.L_direction(f, direction);
+
+  return ensemble.result();
+}
+
+// =================================================================================================
+// wrapper functions: chord-length distribution
+// =================================================================================================
+
+ArrD chordLength(const ArrI &f, const VecI &direction, int phase, bool periodic)
+{
+  Ensemble ensemble(VecS(f.rank(),1), periodic);
+
+  ensemble.chordLength(f, direction, phase);
 
   return ensemble.result();
 }
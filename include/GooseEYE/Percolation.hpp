@@ -0,0 +1,230 @@
+/* =================================================================================================
+
+(c - GPLv3) T.W.J. de Geus (Tom) | tom@geus.me | www.geus.me | github.com/tdegeus/GooseEYE
+
+================================================================================================= */
+
+#ifndef GOOSEEYE_PERCOLATION_HPP
+#define GOOSEEYE_PERCOLATION_HPP
+
+// =================================================================================================
+
+#include "GooseEYE.h"
+
+// =================================================================================================
+
+namespace GooseEYE {
+
+// =================================================================================================
+// constructors
+// =================================================================================================
+
+inline
+Percolation::Percolation(const ArrI &f, bool periodic) :
+  Percolation(f, kernel(f.rank()), periodic)
+{
+}
+
+// -------------------------------------------------------------------------------------------------
+
+inline
+Percolation::Percolation(const ArrI &f, const ArrI &kern, bool periodic) : mRank(f.rank())
+{
+  Private::Connectivity::Value conn = Private::connectivity(kern, mRank);
+
+  // check
+  if ( conn == Private::Connectivity::other )
+    throw std::runtime_error("GooseEYE::Percolation - only the default and the full kernel");
+
+  // shape of the image (3-d)
+  int shape[3] = {1, 1, 1};
+
+  for ( size_t i = 0 ; i < mRank ; ++i ) shape[i] = f.shape<int>(i);
+
+  // label the runs, not linked across the edges (labels in order of first appearance)
+  Private::RunLabels runs = Private::cclRuns(f.data(), shape, mRank, conn, false);
+
+  // view of the image with the runs along the last axis (see "RunLabels"), the first axis of the
+  // image is axis "3-rank" of the view
+  int    H  = runs.shape[0];
+  int    I  = runs.shape[1];
+  int    J  = runs.shape[2];
+  size_t v0 = 3 - mRank;
+
+  // number of voxels per label
+  std::vector<size_t> size = runs.count();
+
+  // faces touched by each label (bits of the axes of the view: "2*v" lower, "2*v+1" upper)
+  std::vector<int> faces(runs.nlab, 0);
+
+  for ( int h = 0 ; h < H ; ++h ) {
+    for ( int i = 0 ; i < I ; ++i ) {
+
+      size_t r    = static_cast<size_t>(h) * I + i;
+      int    mask = 0;
+
+      if ( h == 0   ) mask |= 1 << 0;
+      if ( h == H-1 ) mask |= 1 << 1;
+      if ( i == 0   ) mask |= 1 << 2;
+      if ( i == I-1 ) mask |= 1 << 3;
+
+      for ( size_t n = runs.row[r] ; n < runs.row[r+1] ; ++n ) {
+        int m = mask;
+        if ( runs.begin[n] == 0 ) m |= 1 << 4;
+        if ( runs.end  [n] == J ) m |= 1 << 5;
+        faces[runs.label[n]] |= m;
+      }
+    }
+  }
+
+  // axes of the view spanned by each label (bit "v")
+  std::vector<int> wraps(runs.nlab, 0);
+
+  // not periodic: each label is a cluster, that spans the axes of which it touches both faces
+  if ( ! periodic )
+  {
+    for ( int ilab = 1 ; ilab < runs.nlab ; ++ilab )
+      for ( size_t v = 0 ; v < 3 ; ++v )
+        if ( ( faces[ilab] >> (2*v) & 3 ) == 3 )
+          wraps[ilab] |= 1 << v;
+
+    mCount = static_cast<size_t>(runs.nlab) - 1;
+  }
+
+  // periodic: link the labels across the edges of the image, keeping track of their periodic image
+  // (a link between two labels of the same cluster in different periodic images is a winding)
+  else
+  {
+    Private::OffsetUnionFind links(static_cast<size_t>(runs.nlab));
+
+    auto unite = [&](size_t a, size_t b, const int shift[3])
+    {
+      int oa[3], ob[3];
+      int ra = links.find(runs.label[a], oa);
+      int rb = links.find(runs.label[b], ob);
+
+      if ( ra != rb ) { links.unite(runs.label[a], runs.label[b], shift); return; }
+
+      for ( size_t v = 0 ; v < 3 ; ++v )
+        if ( oa[v] + shift[v] != ob[v] )
+          wraps[ra] |= 1 << v;
+    };
+
+    // - all pairs of runs that are neighbours across an edge
+    Private::cclRunsPeriodic(runs, unite);
+
+    // - clusters in order of first appearance (lowest label), merge the sizes and the windings
+    std::vector<int>    num(runs.nlab, 0);
+    std::vector<size_t> merged(1, 0);
+    std::vector<int>    wrapped(1, 0);
+
+    int nclus = 0;
+
+    for ( int ilab = 1 ; ilab < runs.nlab ; ++ilab ) {
+      int o[3];
+      int r = links.find(ilab, o);
+      if ( num[r] == 0 ) { num[r] = ++nclus; merged.push_back(0); wrapped.push_back(0); }
+      merged [num[r]] += size [ilab];
+      wrapped[num[r]] |= wraps[ilab];
+    }
+
+    size .swap(merged);
+    wraps.swap(wrapped);
+
+    faces.assign(nclus + 1, 0);
+
+    mCount = static_cast<size_t>(nclus);
+  }
+
+  // report the clusters that touch two or more faces, or that wrap (axes of the image)
+  for ( size_t ilab = 1 ; ilab <= mCount ; ++ilab ) {
+
+    int touch = 0;
+    int spans = 0;
+
+    for ( size_t ax = 0 ; ax < mRank ; ++ax ) {
+      touch |= ( faces[ilab] >> (2*(ax+v0)) & 3 ) << (2*ax);
+      spans |= ( wraps[ilab] >> (ax+v0) & 1 ) << ax;
+    }
+
+    size_t ntouch = 0;
+
+    for ( size_t b = 0 ; b < 2*mRank ; ++b ) ntouch += touch >> b & 1;
+
+    if ( ntouch < 2 and spans == 0 ) continue;
+
+    mLabel.push_back(static_cast<int>(ilab));
+    mSize .push_back(size[ilab]);
+    mFaces.push_back(touch);
+    mSpans.push_back(spans);
+  }
+}
+
+// =================================================================================================
+// faces touched by each reported cluster
+// =================================================================================================
+
+inline
+MatI Percolation::faces() const
+{
+  MatI out = MatI::Zero(size(), 2*mRank);
+
+  for ( size_t k = 0 ; k < size() ; ++k )
+    for ( size_t b = 0 ; b < 2*mRank ; ++b )
+      out(k,b) = mFaces[k] >> b & 1;
+
+  return out;
+}
+
+// =================================================================================================
+// axes spanned by each reported cluster
+// =================================================================================================
+
+inline
+MatI Percolation::spans() const
+{
+  MatI out = MatI::Zero(size(), mRank);
+
+  for ( size_t k = 0 ; k < size() ; ++k )
+    for ( size_t ax = 0 ; ax < mRank ; ++ax )
+      out(k,ax) = mSpans[k] >> ax & 1;
+
+  return out;
+}
+
+// =================================================================================================
+// check if a cluster spans an axis
+// =================================================================================================
+
+inline
+bool Percolation::percolates(size_t axis) const
+{
+  if ( axis >= mRank )
+    throw std::runtime_error("GooseEYE::Percolation::percolates - 'axis' out of bounds");
+
+  for ( auto &s : mSpans )
+    if ( s >> axis & 1 )
+      return true;
+
+  return false;
+}
+
+// -------------------------------------------------------------------------------------------------
+
+inline
+bool Percolation::percolates() const
+{
+  for ( auto &s : mSpans )
+    if ( s )
+      return true;
+
+  return false;
+}
+
+// =================================================================================================
+
+} // namespace ...
+
+// =================================================================================================
+
+#endif
@@ -0,0 +1,942 @@
+/* =================================================================================================
+
+(c - GPLv3) T.W.J. de Geus (Tom) | tom@geus.me | www.geus.me | github.com/tdegeus/GooseEYE
+
+================================================================================================= */
+
+#ifndef GOOSEEYE_CCL_HPP
+#define GOOSEEYE_CCL_HPP
+
+// =================================================================================================
+
+#include "GooseEYE.h"
+
+// =================================================================================================
+
+namespace GooseEYE {
+namespace Private {
+
+// -------------------------------------------------------------------------------------------------
+// Connected component labelling for the standard connectivities of "kernel(...)", on raw
+// (row-major) data. The image is 3-d, of which the first "rank" axes are used (the others have
+// shape 1). The result is numbered "1, 2, ..." in order of first appearance in the image (the
+// background is "0"); this numbering does not depend on the labelling algorithm.
+// -------------------------------------------------------------------------------------------------
+
+struct Connectivity {
+  enum Value {
+    other,
+    face,
+    full,
+  };
+};
+
+// =================================================================================================
+// connectivity described by a kernel along the first "rank" axes: a voxel is connected to all
+// neighbours "d" for which "kern(d)" or "kern(-d)" (the kernel may have trailing axes of shape 1)
+// =================================================================================================
+
+inline Connectivity::Value connectivity(const ArrI &kern, size_t rank)
+{
+  // only kernels of shape 3 along the first "rank" axes are recognized
+  if ( kern.rank() < rank or rank < 1 or rank > 3 ) return Connectivity::other;
+
+  for ( size_t i = 0 ; i < kern.rank() ; ++i )
+    if ( kern.shape(i) != ( i < rank ? 3 : 1 ) )
+      return Connectivity::other;
+
+  // compare the symmetric closure of the kernel with face and full connectivity
+  bool isface = true;
+  bool isfull = true;
+
+  for ( size_t k = 0 ; k < kern.size() ; ++k )
+  {
+    // - skip midpoint
+    if ( 2*k+1 == kern.size() ) continue;
+    // - neighbour "d" and "-d" have mirrored linear indices
+    bool in = kern[k] or kern[kern.size()-1-k];
+    // - number of non-zero components of "d"
+    size_t nnz = 0;
+    for ( size_t i = 0, n = k ; i < rank ; ++i, n /= 3 ) nnz += ( n % 3 != 1 );
+    // - compare
+    if ( in != ( nnz == 1 ) ) isface = false;
+    if ( ! in               ) isfull = false;
+  }
+
+  if ( isface ) return Connectivity::face;
+  if ( isfull ) return Connectivity::full;
+
+  return Connectivity::other;
+}
+
+// =================================================================================================
+// periodic images: link the labels of neighbours across the edges of the image
+// ("Links": "UnionFind" or "ConcurrentUnionFind")
+// =================================================================================================
+
+template<class Links>
+inline void cclPeriodic(const int *F, const int *L, const int shape[3], size_t rank, bool full,
+  Links &links)
+{
+  int H = shape[0];
+  int I = shape[1];
+  int J = shape[2];
+
+  // neighbours: face or full connectivity along the first "rank" axes
+  std::vector<int> dx;
+
+  for ( int dh = -1 ; dh <= 1 ; ++dh ) {
+    for ( int di = -1 ; di <= 1 ; ++di ) {
+      for ( int dj = -1 ; dj <= 1 ; ++dj ) {
+        if ( ( rank < 2 and di != 0 ) or ( rank < 3 and dj != 0 ) ) continue;
+        int nnz = ( dh != 0 ) + ( di != 0 ) + ( dj != 0 );
+        if ( nnz == 0 or ( ! full and nnz > 1 ) ) continue;
+        dx.insert(dx.end(), {dh, di, dj});
+      }
+    }
+  }
+
+  // link "(h,i,j)" to its neighbours that are across an edge
+  auto link = [&](int h, int i, int j)
+  {
+    size_t k = ( static_cast<size_t>(h) * I + i ) * J + j;
+
+    if ( ! F[k] ) return;
+
+    for ( size_t n = 0 ; n < dx.size() ; n += 3 )
+    {
+      int a = h + dx[n+0];
+      int b = i + dx[n+1];
+      int c = j + dx[n+2];
+
+      if ( a >= 0 and a < H and b >= 0 and b < I and c >= 0 and c < J ) continue;
+
+      a = ( a + H ) % H;
+      b = ( b + I ) % I;
+      c = ( c + J ) % J;
+
+      size_t m = ( static_cast<size_t>(a) * I + b ) * J + c;
+
+      if ( F[m] ) links.unite(L[k], L[m]);
+    }
+  };
+
+  // loop over voxels at the edge of the image only
+  for ( int h = 0 ; h < H ; ++h ) {
+    for ( int i = 0 ; i < I ; ++i ) {
+      if ( h == 0 or h == H-1 or i == 0 or i == I-1 ) {
+        for ( int j = 0 ; j < J ; ++j ) link(h, i, j);
+      }
+      else {
+        link(h, i, 0);
+        if ( J > 1 ) link(h, i, J-1);
+      }
+    }
+  }
+}
+
+// =================================================================================================
+// renumber in order of first appearance: replace the provisional labels "L" (numbers in "links")
+// by the final labels, return the number of labels (including the background)
+// (if "count" is given: number of voxels per final label, the background is not counted)
+// =================================================================================================
+
+inline int cclRenumber(int *L, size_t size, UnionFind &links, std::vector<size_t> *count=nullptr)
+{
+  std::vector<int> num(links.size(), 0);
+
+  if ( count ) count->assign(1, 0);
+
+  int n = 0;
+
+  for ( size_t k = 0 ; k < size ; ++k ) {
+    if ( L[k] ) {
+      int r = links.find(L[k]);
+      if ( num[r] == 0 ) {
+        num[r] = ++n;
+        if ( count ) count->push_back(0);
+      }
+      L[k] = num[r];
+      if ( count ) (*count)[L[k]]++;
+    }
+  }
+
+  return n+1;
+}
+
+// =================================================================================================
+// face connectivity: one raster scan, linking each voxel to its (at most 3) backward neighbours
+// =================================================================================================
+
+inline int cclFace(const int *F, int *L, const int shape[3], size_t rank, bool periodic,
+  std::vector<size_t> *count=nullptr)
+{
+  int    H  = shape[0];
+  int    I  = shape[1];
+  int    J  = shape[2];
+  size_t IJ = static_cast<size_t>(I) * J;
+
+  // provisional labels (the background "0" is never linked)
+  UnionFind links(1);
+
+  // first pass: provisional labels
+  for ( int h = 0 ; h < H ; ++h ) {
+    for ( int i = 0 ; i < I ; ++i ) {
+      for ( int j = 0 ; j < J ; ++j ) {
+
+        size_t k = h * IJ + static_cast<size_t>(i) * J + j;
+
+        if ( ! F[k] ) { L[k] = 0; continue; }
+
+        // - labels of the backward neighbours (zero if not in the phase, or outside the image)
+        int a = j > 0 ? L[k-1 ] : 0;
+        int b = i > 0 ? L[k-J ] : 0;
+        int c = h > 0 ? L[k-IJ] : 0;
+
+        // - adopt a neighbour's label, link to the others; or create a new label
+        if      ( a ) { L[k] = a; if ( b ) links.unite(a, b); if ( c ) links.unite(a, c); }
+        else if ( b ) { L[k] = b;                             if ( c ) links.unite(b, c); }
+        else if ( c ) { L[k] = c;                                                         }
+        else          { L[k] = links.add();                                               }
+      }
+    }
+  }
+
+  // link across the periodic edges
+  if ( periodic ) cclPeriodic(F, L, shape, rank, false, links);
+
+  // final labels
+  return cclRenumber(L, static_cast<size_t>(H) * IJ, links, count);
+}
+
+// =================================================================================================
+// full connectivity: label blocks of 2 (1-d), 2x2 (2-d), or 2x2x2 (3-d) voxels. All voxels in a
+// block are connected, so only blocks have to be linked. Whether two neighbouring blocks are
+// connected follows from a table lookup with the bitmasks of their voxels.
+// =================================================================================================
+
+// -------------------------------------------------------------------------------------------------
+// "blockReach()[27*mB+D]": bitmask of voxels of a block "A" that touch at least one voxel of the
+// bitmask "mB" of the block "B", for "B" positioned relative to "A" at "D = (dh+1)*9+(di+1)*3+dj+1"
+// (voxel "(a,b,c)" of a block has bit "a*4+b*2+c")
+// -------------------------------------------------------------------------------------------------
+
+inline const std::vector<unsigned char>& blockReach()
+{
+  static const std::vector<unsigned char> table = []()
+  {
+    std::vector<unsigned char> out(27*256, 0);
+
+    for ( int D = 0 ; D < 27 ; ++D )
+    {
+      int dh = D / 9 - 1;
+      int di = ( D / 3 ) % 3 - 1;
+      int dj = D % 3 - 1;
+
+      for ( int mB = 0 ; mB < 256 ; ++mB ) {
+        for ( int b = 0 ; b < 8 ; ++b ) {
+          if ( ! ( mB & ( 1 << b ) ) ) continue;
+          for ( int a = 0 ; a < 8 ; ++a ) {
+            // voxel "b" in "B" relative to voxel "a" in "A"
+            int x = ( b >> 2 )     + 2 * dh - ( a >> 2 );
+            int y = ( b >> 1 & 1 ) + 2 * di - ( a >> 1 & 1 );
+            int z = ( b      & 1 ) + 2 * dj - ( a      & 1 );
+            if ( std::abs(x) <= 1 and std::abs(y) <= 1 and std::abs(z) <= 1 )
+              out[27*mB+D] |= static_cast<unsigned char>(1 << a);
+          }
+        }
+      }
+    }
+
+    return out;
+  }();
+
+  return table;
+}
+
+// -------------------------------------------------------------------------------------------------
+
+inline int cclFull(const int *F, int *L, const int shape[3], size_t rank, bool periodic,
+  std::vector<size_t> *count=nullptr)
+{
+  int    H  = shape[0];
+  int    I  = shape[1];
+  int    J  = shape[2];
+  size_t IJ = static_cast<size_t>(I) * J;
+
+  // size of the blocks along each axis, and number of blocks along each axis
+  int s[3] = {1, 1, 1};
+
+  for ( size_t ax = 0 ; ax < rank ; ++ax ) s[ax] = 2;
+
+  int BH = ( H + s[0] - 1 ) / s[0];
+  int BI = ( I + s[1] - 1 ) / s[1];
+  int BJ = ( J + s[2] - 1 ) / s[2];
+
+  // backward neighbouring blocks (along the first "rank" axes): [ [dh, di, dj, D], ... ]
+  std::vector<int> back;
+
+  for ( int D = 0 ; D < 13 ; ++D ) {
+    int dh = D / 9 - 1;
+    int di = ( D / 3 ) % 3 - 1;
+    int dj = D % 3 - 1;
+    if ( ( rank < 2 and di != 0 ) or ( rank < 3 and dj != 0 ) ) continue;
+    back.insert(back.end(), {dh, di, dj, D});
+  }
+
+  // lookup table
+  const unsigned char *reach = blockReach().data();
+
+  // bitmask of the voxels in the phase for each block, and label of each block
+  std::vector<unsigned char> mask (static_cast<size_t>(BH) * BI * BJ, 0);
+  std::vector<int>           label(static_cast<size_t>(BH) * BI * BJ, 0);
+
+  for ( int h = 0 ; h < H ; ++h )
+    for ( int i = 0 ; i < I ; ++i )
+      for ( int j = 0 ; j < J ; ++j )
+        if ( F[h * IJ + static_cast<size_t>(i) * J + j] )
+          mask[ ( static_cast<size_t>(h/s[0]) * BI + i/s[1] ) * BJ + j/s[2] ] |=
+            static_cast<unsigned char>( 1 << ( (h%s[0]) * 4 + (i%s[1]) * 2 + (j%s[2]) ) );
+
+  // provisional labels (the background "0" is never linked)
+  UnionFind links(1);
+
+  // first pass: provisional labels of the blocks
+  for ( int bh = 0 ; bh < BH ; ++bh ) {
+    for ( int bi = 0 ; bi < BI ; ++bi ) {
+      for ( int bj = 0 ; bj < BJ ; ++bj ) {
+
+        size_t k  = ( static_cast<size_t>(bh) * BI + bi ) * BJ + bj;
+        int    mA = mask[k];
+
+        if ( ! mA ) continue;
+
+        // - link to each connected backward neighbour
+        for ( size_t n = 0 ; n < back.size() ; n += 4 )
+        {
+          int a = bh + back[n+0];
+          int b = bi + back[n+1];
+          int c = bj + back[n+2];
+
+          if ( a < 0 or b < 0 or b >= BI or c < 0 or c >= BJ ) continue;
+
+          size_t m = ( static_cast<size_t>(a) * BI + b ) * BJ + c;
+
+          if ( ! ( mA & reach[27*mask[m]+back[n+3]] ) ) continue;
+
+          if ( label[k] ) links.unite(label[k], label[m]);
+          else            label[k] = label[m];
+        }
+
+        // - not connected: new label
+        if ( ! label[k] ) label[k] = links.add();
+      }
+    }
+  }
+
+  // provisional labels of the voxels
+  for ( int h = 0 ; h < H ; ++h ) {
+    for ( int i = 0 ; i < I ; ++i ) {
+      for ( int j = 0 ; j < J ; ++j ) {
+        size_t k = h * IJ + static_cast<size_t>(i) * J + j;
+        L[k] = F[k] ? label[ ( static_cast<size_t>(h/s[0]) * BI + i/s[1] ) * BJ + j/s[2] ] : 0;
+      }
+    }
+  }
+
+  // link across the periodic edges
+  if ( periodic ) cclPeriodic(F, L, shape, rank, true, links);
+
+  // final labels
+  return cclRenumber(L, static_cast<size_t>(H) * IJ, links, count);
+}
+
+// =================================================================================================
+// parallel labelling: the image is split in slabs along the first axis that are labelled
+// independently. Each slab numbers its provisional labels "1, 2, ..." in order of their first
+// voxel (of the (partial) cluster, or (full connectivity) of the block), and offsets them by the
+// number of labels of the preceding slabs (prefix sum). The provisional labels are thus numbered in
+// image order, and bounded by the number of (partial) clusters or blocks, not by the number of
+// voxels. All labels are merged with a concurrent union-find that always keeps the lowest label as
+// root, such that the root of each cluster is the label of its first voxel, whatever the order in
+// which the slabs are labelled and merged. Numbering the roots in increasing order gives the
+// numbering in order of first appearance without a serial pass.
+// =================================================================================================
+
+inline int cclParallel(const int *F, int *L, const int shape[3], size_t rank,
+  Connectivity::Value conn, bool periodic, size_t nthreads, std::vector<size_t> *count=nullptr)
+{
+  int    H  = shape[0];
+  int    I  = shape[1];
+  int    J  = shape[2];
+  size_t IJ = static_cast<size_t>(I) * J;
+  bool   full = ( conn == Connectivity::full );
+
+  // size of the blocks along each axis (full connectivity; face connectivity: one voxel)
+  int s[3] = {1, 1, 1};
+
+  if ( full )
+    for ( size_t ax = 0 ; ax < rank ; ++ax )
+      s[ax] = 2;
+
+  int BH = ( H + s[0] - 1 ) / s[0];
+  int BI = ( I + s[1] - 1 ) / s[1];
+  int BJ = ( J + s[2] - 1 ) / s[2];
+
+  // slabs: "slab[islab] <= bh < slab[islab+1]" (in blocks), the voxels "h" follow by "s[0]"
+  size_t nslab = std::min(threads(nthreads), static_cast<size_t>(BH));
+
+  std::vector<int> slab(nslab+1);
+
+  for ( size_t islab = 0 ; islab <= nslab ; ++islab )
+    slab[islab] = static_cast<int>( islab * BH / nslab );
+
+  auto hbegin = [&](size_t islab) { return std::min(slab[islab  ] * s[0], H); };
+  auto hend   = [&](size_t islab) { return std::min(slab[islab+1] * s[0], H); };
+
+  // provisional labels of each slab, numbered from one (the background "0" is never linked)
+  std::vector<UnionFind> local(nslab, UnionFind(1));
+
+  // full connectivity: bitmask of the voxels in the phase and label of each block
+  std::vector<unsigned char> mask;
+  std::vector<int>           label;
+
+  if ( full ) {
+    mask .assign(static_cast<size_t>(BH) * BI * BJ, 0);
+    label.assign(static_cast<size_t>(BH) * BI * BJ, 0);
+  }
+
+  // -----------------------------------------
+  // first pass: label each slab independently
+  // -----------------------------------------
+
+  auto scanFace = [&](size_t islab)
+  {
+    UnionFind &links = local[islab];
+
+    int h0 = hbegin(islab);
+
+    for ( int h = h0 ; h < hend(islab) ; ++h ) {
+      for ( int i = 0 ; i < I ; ++i ) {
+        for ( int j = 0 ; j < J ; ++j ) {
+
+          size_t k = h * IJ + static_cast<size_t>(i) * J + j;
+
+          if ( ! F[k] ) { L[k] = 0; continue; }
+
+          // - labels of the backward neighbours in the slab
+          int a = j > 0  ? L[k-1 ] : 0;
+          int b = i > 0  ? L[k-J ] : 0;
+          int c = h > h0 ? L[k-IJ] : 0;
+
+          // - adopt a neighbour's label, link to the others; or create a new label
+          if      ( a ) { L[k] = a; if ( b ) links.unite(a, b); if ( c ) links.unite(a, c); }
+          else if ( b ) { L[k] = b;                             if ( c ) links.unite(b, c); }
+          else if ( c ) { L[k] = c;                                                         }
+          else          { L[k] = links.add();                                               }
+        }
+      }
+    }
+  };
+
+  auto scanFull = [&](size_t islab)
+  {
+    UnionFind &links = local[islab];
+
+    // - backward neighbouring blocks (along the first "rank" axes): [ [dh, di, dj, D], ... ]
+    std::vector<int> back;
+
+    for ( int D = 0 ; D < 13 ; ++D ) {
+      int dh = D / 9 - 1;
+      int di = ( D / 3 ) % 3 - 1;
+      int dj = D % 3 - 1;
+      if ( ( rank < 2 and di != 0 ) or ( rank < 3 and dj != 0 ) ) continue;
+      back.insert(back.end(), {dh, di, dj, D});
+    }
+
+    const unsigned char *reach = blockReach().data();
+
+    // - bitmask of the blocks in the slab; each block gets a new label at its first voxel (in image
+    //   order), such that the first voxel of each cluster is in the block with its lowest label
+    for ( int h = hbegin(islab) ; h < hend(islab) ; ++h ) {
+      for ( int i = 0 ; i < I ; ++i ) {
+        for ( int j = 0 ; j < J ; ++j ) {
+          if ( ! F[h * IJ + static_cast<size_t>(i) * J + j] ) continue;
+          size_t m = ( static_cast<size_t>(h/s[0]) * BI + i/s[1] ) * BJ + j/s[2];
+          mask[m] |= static_cast<unsigned char>( 1 << ( (h%s[0]) * 4 + (i%s[1]) * 2 + (j%s[2]) ) );
+          if ( ! label[m] ) label[m] = links.add();
+        }
+      }
+    }
+
+    // - link each block to its connected backward neighbours in the slab
+    for ( int bh = slab[islab] ; bh < slab[islab+1] ; ++bh ) {
+      for ( int bi = 0 ; bi < BI ; ++bi ) {
+        for ( int bj = 0 ; bj < BJ ; ++bj ) {
+
+          size_t k  = ( static_cast<size_t>(bh) * BI + bi ) * BJ + bj;
+          int    mA = mask[k];
+
+          if ( ! mA ) continue;
+
+          for ( size_t n = 0 ; n < back.size() ; n += 4 )
+          {
+            int a = bh + back[n+0];
+            int b = bi + back[n+1];
+            int c = bj + back[n+2];
+
+            if ( a < slab[islab] or b < 0 or b >= BI or c < 0 or c >= BJ ) continue;
+
+            size_t m = ( static_cast<size_t>(a) * BI + b ) * BJ + c;
+
+            if ( mA & reach[27*mask[m]+back[n+3]] ) links.unite(label[k], label[m]);
+          }
+        }
+      }
+    }
+  };
+
+  parallel_for(nslab, nslab, [&](size_t islab, size_t) {
+    if ( full ) scanFull(islab);
+    else        scanFace(islab);
+  });
+
+  // ---------------------------------------------------------------
+  // global provisional labels: offset the labels of each slab by the
+  // number of labels of the preceding slabs
+  // ---------------------------------------------------------------
+
+  // - first label of each slab: "base[islab] < label <= base[islab+1]"
+  std::vector<size_t> base(nslab+1, 0);
+
+  for ( size_t islab = 0 ; islab < nslab ; ++islab )
+    base[islab+1] = base[islab] + local[islab].size() - 1;
+
+  if ( base[nslab] >= static_cast<size_t>(std::numeric_limits<int>::max()) )
+    throw std::runtime_error("GooseEYE::Private::ccl - too many labels for 'int'");
+
+  ConcurrentUnionFind links(base[nslab] + 1);
+
+  links.reset(0);
+
+  // - copy the sets of each slab (linked to their lowest label), and offset the voxels' labels
+  parallel_for(nslab, nslab, [&](size_t islab, size_t)
+  {
+    UnionFind &loc = local[islab];
+    int        off = static_cast<int>(base[islab]);
+
+    std::vector<int> lowest(loc.size(), 0);
+
+    for ( int a = 1 ; a < static_cast<int>(loc.size()) ; ++a ) {
+      int r = loc.find(a);
+      if ( ! lowest[r] ) lowest[r] = a;
+      links.set(off + a, off + lowest[r]);
+    }
+
+    loc = UnionFind();
+
+    for ( int h = hbegin(islab) ; h < hend(islab) ; ++h ) {
+      for ( int i = 0 ; i < I ; ++i ) {
+        for ( int j = 0 ; j < J ; ++j ) {
+          size_t k = h * IJ + static_cast<size_t>(i) * J + j;
+          size_t m = ( static_cast<size_t>(h/s[0]) * BI + i/s[1] ) * BJ + j/s[2];
+          if      ( ! F[k] ) L[k] = 0;
+          else if ( full   ) L[k] = off + label[m];
+          else               L[k] += off;
+        }
+      }
+    }
+  });
+
+  // -----------------------------------------------------------------
+  // link the slabs: neighbours across the first voxel-row of each slab
+  // -----------------------------------------------------------------
+
+  parallel_for(nslab-1, nslab, [&](size_t iface, size_t)
+  {
+    int h = hbegin(iface+1);
+
+    for ( int i = 0 ; i < I ; ++i ) {
+      for ( int j = 0 ; j < J ; ++j ) {
+
+        size_t k = h * IJ + static_cast<size_t>(i) * J + j;
+
+        if ( ! F[k] ) continue;
+
+        for ( int di = -1 ; di <= 1 ; ++di ) {
+          for ( int dj = -1 ; dj <= 1 ; ++dj ) {
+            if ( ( ! full or rank < 2 ) and di != 0 ) continue;
+            if ( ( ! full or rank < 3 ) and dj != 0 ) continue;
+            if ( i+di < 0 or i+di >= I or j+dj < 0 or j+dj >= J ) continue;
+            size_t m = ( h - 1 ) * IJ + static_cast<size_t>(i+di) * J + ( j + dj );
+            if ( F[m] ) links.unite(L[k], L[m]);
+          }
+        }
+      }
+    }
+  });
+
+  // link across the periodic edges
+  if ( periodic ) cclPeriodic(F, L, shape, rank, full, links);
+
+  // -------------------------------------------------------
+  // final labels: number the roots in increasing order
+  // (the order of the first voxels of the clusters)
+  // -------------------------------------------------------
+
+  // - count the roots per slab
+  std::vector<int> nroot(nslab+1, 0);
+
+  parallel_for(nslab, nslab, [&](size_t islab, size_t)
+  {
+    for ( size_t a = base[islab] + 1 ; a <= base[islab+1] ; ++a )
+      if ( static_cast<size_t>(links.find(static_cast<int>(a))) == a )
+        nroot[islab+1]++;
+  });
+
+  // - first number in each slab
+  std::partial_sum(nroot.begin(), nroot.end(), nroot.begin());
+
+  // - number the roots
+  std::vector<int> num(links.size(), 0);
+
+  parallel_for(nslab, nslab, [&](size_t islab, size_t)
+  {
+    int n = nroot[islab];
+
+    for ( size_t a = base[islab] + 1 ; a <= base[islab+1] ; ++a )
+      if ( links.parent(static_cast<int>(a)) == static_cast<int>(a) )
+        num[a] = ++n;
+  });
+
+  // - apply (and count the voxels per label, per slab)
+  int nlab = nroot[nslab] + 1;
+
+  std::vector<std::vector<size_t>> part(count ? nslab : 0);
+
+  parallel_for(nslab, nslab, [&](size_t islab, size_t)
+  {
+    if ( count ) part[islab].assign(nlab, 0);
+
+    for ( size_t k = hbegin(islab) * IJ ; k < hend(islab) * IJ ; ++k ) {
+      if ( L[k] ) {
+        L[k] = num[links.find(L[k])];
+        if ( count ) part[islab][L[k]]++;
+      }
+    }
+  });
+
+  if ( count ) {
+    count->assign(nlab, 0);
+    for ( auto &n : part )
+      for ( int ilab = 1 ; ilab < nlab ; ++ilab )
+        (*count)[ilab] += n[ilab];
+  }
+
+  return nlab;
+}
+
+// =================================================================================================
+// Labels of the runs of voxels of a binary image. The image is viewed as 3-d, with the runs along
+// the last axis: shape "(1,1,N)" (1-d), "(1,H,I)" (2-d), or "(H,I,J)" (3-d), which all have the same
+// row-major storage as the image. Memory and time scale with the number of runs (and rows).
+// =================================================================================================
+
+struct RunLabels
+{
+  size_t              rank;     // rank of the image
+  int                 shape[3]; // shape of the (3-d) view of the image
+  bool                full;     // full connectivity (otherwise face)
+  std::vector<size_t> row;      // runs of row "h*shape[1]+i": "row[r] <= n < row[r+1]"
+  std::vector<int>    begin;    // first voxel of each run (along the last axis)
+  std::vector<int>    end;      // last voxel (exclusive) of each run
+  std::vector<int>    label;    // label of each run
+  int                 nlab;     // number of labels (including the background)
+
+  // number of runs
+  size_t size() const { return begin.size(); }
+
+  // write the labels of all voxels to "L" (row-major, the background is set to "0")
+  void paint(int *L) const;
+
+  // number of voxels per label (the background is not counted)
+  std::vector<size_t> count() const;
+};
+
+// -------------------------------------------------------------------------------------------------
+
+inline void RunLabels::paint(int *L) const
+{
+  size_t J = static_cast<size_t>(shape[2]);
+
+  std::fill(L, L + ( row.size() - 1 ) * J, 0);
+
+  for ( size_t r = 0 ; r + 1 < row.size() ; ++r )
+    for ( size_t n = row[r] ; n < row[r+1] ; ++n )
+      std::fill(L + r * J + begin[n], L + r * J + end[n], label[n]);
+}
+
+// -------------------------------------------------------------------------------------------------
+
+inline std::vector<size_t> RunLabels::count() const
+{
+  std::vector<size_t> out(nlab, 0);
+
+  for ( size_t n = 0 ; n < begin.size() ; ++n ) out[label[n]] += end[n] - begin[n];
+
+  return out;
+}
+
+// =================================================================================================
+// label the runs of "F" with face or full connectivity (in order of first appearance, like "ccl")
+// =================================================================================================
+
+inline RunLabels cclRuns(const int *F, const int shape[3], size_t rank, Connectivity::Value conn,
+  bool periodic)
+{
+  RunLabels out;
+
+  // view of the image with the runs along the last axis
+  out.rank = rank;
+
+  for ( size_t ax = 0 ; ax < 3 ; ++ax ) out.shape[ax] = 1;
+
+  for ( size_t ax = 0 ; ax < rank ; ++ax ) out.shape[ax+3-rank] = shape[ax];
+
+  out.full = ( conn == Connectivity::full );
+
+  int  H    = out.shape[0];
+  int  I    = out.shape[1];
+  int  J    = out.shape[2];
+  bool full = out.full;
+
+  // run-length encoding of each row
+  out.row.assign(static_cast<size_t>(H) * I + 1, 0);
+
+  for ( size_t r = 0 ; r < static_cast<size_t>(H) * I ; ++r )
+  {
+    const int *row = F + r * J;
+
+    for ( int j = 0 ; j < J ; ) {
+      if ( ! row[j] ) { ++j; continue; }
+      out.begin.push_back(j);
+      while ( j < J and row[j] ) ++j;
+      out.end.push_back(j);
+    }
+
+    out.row[r+1] = out.begin.size();
+  }
+
+  // provisional labels: one per run ("n+1" for run "n"; the background "0" is never linked)
+  UnionFind links(out.size() + 1);
+
+  // link the overlapping runs of rows "r" and "s" (full connectivity: also diagonally)
+  auto unite = [&](size_t a, size_t b) {
+    links.unite(static_cast<int>(a+1), static_cast<int>(b+1));
+  };
+
+  auto link = [&](size_t r, size_t s)
+  {
+    int d = full ? 1 : 0;
+
+    size_t a = out.row[r], b = out.row[s];
+
+    // - merge the sorted lists of runs
+    while ( a < out.row[r+1] and b < out.row[s+1] )
+    {
+      if ( out.begin[a] < out.end[b] + d and out.begin[b] < out.end[a] + d ) unite(a, b);
+
+      if ( out.end[a] < out.end[b] ) ++a;
+      else                           ++b;
+    }
+
+    // - periodic, full connectivity: diagonal neighbours across the end of the rows
+    if ( periodic and full and r != s and out.row[r] < out.row[r+1] and out.row[s] < out.row[s+1] )
+    {
+      size_t a0 = out.row[r], a1 = out.row[r+1] - 1;
+      size_t b0 = out.row[s], b1 = out.row[s+1] - 1;
+
+      if ( out.begin[a0] == 0 and out.end[b1] == J ) unite(a0, b1);
+      if ( out.begin[b0] == 0 and out.end[a1] == J ) unite(b0, a1);
+    }
+  };
+
+  // link each row to its neighbouring rows: backward rows, and (periodic) rows across the edges
+  for ( int h = 0 ; h < H ; ++h ) {
+    for ( int i = 0 ; i < I ; ++i ) {
+
+      size_t r = static_cast<size_t>(h) * I + i;
+
+      // - runs connected across the end of the row
+      if ( periodic and out.row[r] < out.row[r+1] ) {
+        size_t a0 = out.row[r], a1 = out.row[r+1] - 1;
+        if ( out.begin[a0] == 0 and out.end[a1] == J ) unite(a0, a1);
+      }
+
+      // - neighbouring rows: "(h, i-1)", "(h-1, i)", and (full connectivity) "(h-1, i+-1)"
+      for ( int dh = -1 ; dh <= 0 ; ++dh ) {
+        for ( int di = -1 ; di <= 1 ; ++di ) {
+
+          if ( dh == 0 and di != -1 ) continue;
+          if ( ! full and dh != 0 and di != 0 ) continue;
+
+          int a = h + dh;
+          int b = i + di;
+
+          if ( periodic ) {
+            a = ( a + H ) % H;
+            b = ( b + I ) % I;
+          }
+          else if ( a < 0 or b < 0 or b >= I ) {
+            continue;
+          }
+
+          link(r, static_cast<size_t>(a) * I + b);
+        }
+      }
+    }
+  }
+
+  // final labels, in order of first appearance (the runs are stored in order of first appearance)
+  std::vector<int> num(out.size() + 1, 0);
+
+  out.label.resize(out.size());
+  out.nlab = 1;
+
+  for ( size_t n = 0 ; n < out.size() ; ++n ) {
+    int r = links.find(static_cast<int>(n+1));
+    if ( num[r] == 0 ) num[r] = out.nlab++;
+    out.label[n] = num[r];
+  }
+
+  return out;
+}
+
+// =================================================================================================
+// periodic images: call "func(a, b, shift)" for each pair of runs "a" and "b" that are neighbours
+// across an edge of the image (for runs labelled as if the image were not periodic), with "shift"
+// the periodic image of run "b" relative to run "a" (axes of the view, in multiples of its shape)
+// =================================================================================================
+
+template<class Func>
+inline void cclRunsPeriodic(const RunLabels &runs, Func func)
+{
+  int    H  = runs.shape[0];
+  int    I  = runs.shape[1];
+  int    J  = runs.shape[2];
+  size_t v0 = 3 - runs.rank;
+
+  // - runs connected across the end of a row
+  int dj[3] = {0, 0, 1};
+
+  for ( size_t r = 0 ; r + 1 < runs.row.size() ; ++r ) {
+    if ( runs.row[r] == runs.row[r+1] ) continue;
+    size_t a0 = runs.row[r], a1 = runs.row[r+1] - 1;
+    if ( runs.begin[a0] == 0 and runs.end[a1] == J ) func(a1, a0, dj);
+  }
+
+  // - neighbouring rows "(h+dh, i+di)": link the rows across an edge, and (full connectivity) the
+  //   runs that are diagonal neighbours across the end of the rows
+  for ( int h = 0 ; h < H ; ++h ) {
+    for ( int i = 0 ; i < I ; ++i ) {
+      for ( int dh = 0 ; dh <= 1 ; ++dh ) {
+        for ( int di = -1 ; di <= 1 ; ++di ) {
+
+          if ( dh == 0 and di != 1 ) continue;
+          if ( ! runs.full and dh != 0 and di != 0 ) continue;
+          if ( ( dh != 0 and v0 > 0 ) or ( di != 0 and v0 > 1 ) ) continue;
+
+          int a = h + dh;
+          int b = i + di;
+
+          // -- number of periods crossed
+          int n[3] = {( a + H ) / H - 1, ( b + I ) / I - 1, 0};
+
+          a -= n[0] * H;
+          b -= n[1] * I;
+
+          size_t r = static_cast<size_t>(h) * I + i;
+          size_t s = static_cast<size_t>(a) * I + b;
+
+          size_t p = runs.row[r], q = runs.row[s];
+
+          // -- overlapping runs (full connectivity: also diagonally), only if an edge is crossed
+          if ( n[0] != 0 or n[1] != 0 ) {
+            int d = runs.full ? 1 : 0;
+            while ( p < runs.row[r+1] and q < runs.row[s+1] ) {
+              if ( runs.begin[p] < runs.end[q] + d and runs.begin[q] < runs.end[p] + d )
+                func(p, q, n);
+              if ( runs.end[p] < runs.end[q] ) ++p;
+              else                             ++q;
+            }
+          }
+
+          // -- full connectivity: diagonal neighbours across the end of the rows
+          if ( runs.full and runs.row[r] < runs.row[r+1] and runs.row[s] < runs.row[s+1] ) {
+            size_t p0 = runs.row[r], p1 = runs.row[r+1] - 1;
+            size_t q0 = runs.row[s], q1 = runs.row[s+1] - 1;
+            int    m[3] = {n[0], n[1], +1};
+            int    w[3] = {n[0], n[1], -1};
+            if ( runs.end[p1] == J and runs.begin[q0] == 0 ) func(p1, q0, m);
+            if ( runs.begin[p0] == 0 and runs.end[q1] == J ) func(p0, q1, w);
+          }
+        }
+      }
+    }
+  }
+}
+
+// =================================================================================================
+// check if the image is sparse along its rows: less than one run per 8 voxels (on average), such
+// that labelling the runs is cheaper than labelling the voxels
+// =================================================================================================
+
+inline bool cclSparse(const int *F, const int shape[3], size_t rank)
+{
+  size_t J = static_cast<size_t>(shape[rank-1]);
+  size_t N = static_cast<size_t>(shape[0]) * shape[1] * shape[2];
+  size_t n = 0;
+
+  for ( size_t k = 0 ; k < N ; ++k )
+    if ( F[k] and ( k % J == 0 or ! F[k-1] ) )
+      ++n;
+
+  return 8 * n < N;
+}
+
+// =================================================================================================
+// label "F" (written to "L") with face or full connectivity, return the number of labels
+// (including the background). "nthreads > 1": label in parallel (identical result); serial, sparse
+// image: label the runs. If "count" is given: number of voxels per label (the background is not
+// counted), accumulated while writing the final labels.
+// =================================================================================================
+
+inline int ccl(const int *F, int *L, const int shape[3], size_t rank, Connectivity::Value conn,
+  bool periodic, size_t nthreads=1, std::vector<size_t> *count=nullptr)
+{
+  if ( conn != Connectivity::face and conn != Connectivity::full )
+    throw std::runtime_error("GooseEYE::Private::ccl - unknown connectivity");
+
+  if ( threads(nthreads) > 1 and shape[0] > 2 )
+    return cclParallel(F, L, shape, rank, conn, periodic, nthreads, count);
+
+  if ( cclSparse(F, shape, rank) ) {
+    RunLabels runs = cclRuns(F, shape, rank, conn, periodic);
+    runs.paint(L);
+    if ( count ) *count = runs.count();
+    return runs.nlab;
+  }
+
+  if ( conn == Connectivity::face ) return cclFace(F, L, shape, rank, periodic, count);
+
+  return cclFull(F, L, shape, rank, periodic, count);
+}
+
+// =================================================================================================
+
+} // namespace Private
+} // namespace GooseEYE
+
+// =================================================================================================
+
+#endif
@@ -21,87 +21,80 @@ namespace GooseEYE {
 
 namespace Private {
 
+// -------------------------------------------------------------------------------------------------
+// periodic images: link the labels "l" of the voxels of "f" (3-d, labelled as if the image were not
+// periodic) to the labels of their neighbours across the edges of the image, keeping track of the
+// periodic image of each label (see "OffsetUnionFind")
 // -------------------------------------------------------------------------------------------------
 
-void _link ( std::vector<int> &linked, int a, int b )
+inline void linkPeriodic(const ArrI &f, const ArrI &l, const KernelOffsets &offsets,
+  OffsetUnionFind &shifts)
 {
+  int h,i,j;
 
-  if ( a==b )
-    return;
+  int H  = static_cast<int>(f.shape(0));
+  int I  = static_cast<int>(f.shape(1));
+  int J  = static_cast<int>(f.shape(2));
+  int dH = offsets.mid()[0];
+  int dI = offsets.mid()[1];
+  int dJ = offsets.mid()[2];
 
-  int i,c;
+  int N[3] = {H, I, J};
 
-  if ( a>b ) {
-    c = a;
-    a = b;
-    b = c;
-  }
+  // link each voxel near an edge to its neighbours (also across the edge, in a periodic image)
+  for ( h=0 ; h<H ; h++ ) {
+    for ( i=0 ; i<I ; i++ ) {
 
-  // both unlinked
-  // -------------
+      // - interior of the row (no neighbours across an edge) is skipped
+      bool row = ( h < dH or h >= H-dH or i < dI or i >= I-dI );
 
-  if ( linked[a]==a && linked[b]==b ) {
-    linked[a] = b;
-    linked[b] = a;
-    return;
-  }
+      for ( j=0 ; j<J ; j++ ) {
 
-  // a linked / b unlinked
-  // ---------------------
+        if ( !row and j >= dJ and j < J-dJ ) { j = J-dJ-1; continue; }
 
-  if ( linked[a]!=a && linked[b]==b ) {
-    linked[b] = linked[a];
-    linked[a] = b;
-    return;
-  }
+        if ( !f(h,i,j) ) continue;
 
-  // a unlinked / b linked
-  // ---------------------
+        for ( size_t k=0 ; k<offsets.all().size() ; k+=3 ) {
 
-  if ( linked[a]==a && linked[b]!=b ) {
-    linked[a] = linked[b];
-    linked[b] = a;
-    return;
-  }
+          const int *d = &offsets.all()[k];
 
-  // both linked -> to each other
-  // ----------------------------
+          // - neighbour, and the number of periods it is shifted to fall in the image
+          int y[3] = {h+d[0], i+d[1], j+d[2]};
+          int n[3];
 
-  i = a;
-  while ( 1 ) {
-    if ( linked[i]==b ) { return; }
-    i = linked[i];
-    if ( i==a ) { break; }
-  }
+          for ( size_t ax=0 ; ax<3 ; ax++ ) {
+            n[ax]  = ( y[ax] >= 0 ) ? y[ax] / N[ax] : -( ( N[ax] - 1 - y[ax] ) / N[ax] );
+            y[ax] -= n[ax] * N[ax];
+          }
 
-  // both linked -> to different groups
-  // ----------------------------------
+          // - neighbour in the image: linked by the labelling
+          if ( n[0]==0 and n[1]==0 and n[2]==0 ) continue;
 
-  c = linked[a];
-  linked[a] = b;
+          // - link (a cluster that is connected to its own periodic image is not unwrapped)
+          if ( f(y[0],y[1],y[2]) )
+            shifts.unite(l(h,i,j), l(y[0],y[1],y[2]), n);
+        }
 
-  i = a;
-  while ( 1 ) {
-    i = linked[i];
-    if ( linked[i]==b ) { break; }
+      }
+    }
   }
-  linked[i] = c;
-
-  return;
-
 }
 
 // -------------------------------------------------------------------------------------------------
 
-std::tuple<ArrI,ArrI> clusters(ArrI f, ArrI kern, int min_size, bool periodic)
+std::tuple<ArrI,ArrI> clusters(ArrI f, ArrI kern, int min_size, bool periodic, size_t nthreads)
 {
-  int h,i,j,di,dj,dh,H,I,J,lH,lI,lJ,uH,uI,uJ,dI,dJ,dH,ii,jj,ilab,nlab;
+  int h,i,j,H,I,J,ilab,nlab;
 
-  // cluster links (e.g. 4 coupled to 2: lnk[4]=2)
-  std::vector<int> lnk(f.size());
+  // cluster links: disjoint sets of labels (the background "0" is never linked)
+  UnionFind links(1);
 
-  // saved clusters: 1=saved, 0=not-saved
-  std::vector<int> inc(f.size());
+  // new label of each cluster, and new number of the included clusters (0=not-included)
+  std::vector<int> lnk;
+  std::vector<int> inc;
+
+  // number of voxels per label
+  std::vector<size_t> size;
 
   // zero-initialize result
   ArrI l = ArrI::Zero(f.shape());
@@ -113,212 +106,195 @@ std::tuple<ArrI,ArrI> clusters(ArrI f, ArrI kern, int min_size, bool periodic)
   c   .setPeriodic(periodic);
   kern.setPeriodic(periodic);
 
+  // connectivity described by the kernel (standard connectivities are labelled more efficiently)
+  // (ignoring trailing axes of shape 1)
+  size_t rank = f.rank();
+
+  while ( rank > 1 and f.shape(rank-1) == 1 ) --rank;
+
+  Connectivity::Value conn = connectivity(kern, rank);
+
   // change rank to 3 (to simplify implementation)
   f   .chrank(3);
   kern.chrank(3);
 
-  // get half shape of the kernel
-  VecS mid = kern.shape();
-
   // check
-  for ( auto &i : mid )
+  for ( auto &i : kern.shape() )
     if ( i%2 == 0 )
       throw std::runtime_error("'kernel' must be odd shaped");
 
-  // midpoint
-  for ( auto &i : mid ) i = (i-1)/2;
+  // non-zero entries of the kernel as offsets relative to its midpoint
+  KernelOffsets offsets(kern);
 
   // get shape
   H  = f.shape(0);
   I  = f.shape(1);
   J  = f.shape(2);
-  dH = mid[0];
-  dI = mid[1];
-  dJ = mid[2];
 
   // ---------------
   // basic labelling
   // ---------------
 
-  // current label
-  ilab = 0;
-
-  // initialize cluster-links (only coupled to self)
-  for ( i=0 ; i<(int)f.size() ; i++ )
-    lnk[i] = i;
-  // initialize: no saved clusters, except background (inc[0]=1)
-  inc[0] = 1;
-  for ( size_t i=1 ; i<f.size() ; i++ )
-    inc[i] = 0;
-
-  // periodic: lower/upper bound of the kernel always == (shape[i]-1)/2
-  if ( periodic ) {
-    lH = -dH; uH = +dH;
-    lI = -dI; uI = +dI;
-    lJ = -dJ; uJ = +dJ;
+  // N.B. the image is first labelled as if it were not periodic, for periodic images the labels are
+  // linked across the edges of the image below (keeping track of the periodic image of each label)
+
+  // standard connectivity: dedicated algorithm (labels in order of first appearance, like below)
+  // (in parallel if "nthreads > 1")
+  if ( conn != Connectivity::other )
+  {
+    int shape[3] = {H, I, J};
+
+    nlab = ccl(f.data(), l.data(), shape, rank, conn, false, nthreads, &size);
   }
 
-  // loop through voxels (in all directions)
-  for ( h=0 ; h<H ; h++ ) {
-    for ( i=0 ; i<I ; i++ ) {
-      for ( j=0 ; j<J ; j++ ) {
+  // other kernels: link each voxel to its backward neighbours (serial)
+  else
+  {
+    const std::vector<int> &half = offsets.half();
 
-        // only continue for non-zero voxels
-        if ( f(h,i,j) ) {
-
-          // set lower/upper bound of the kernel near edges
-          // -> avoids reading out-of-bounds
-          if ( !periodic ) {
-            if ( h <    dH ) lH=0; else lH=-dH;
-            if ( i <    dI ) lI=0; else lI=-dI;
-            if ( j <    dJ ) lJ=0; else lJ=-dJ;
-            if ( h >= H-dH ) uH=0; else uH=+dH;
-            if ( i >= I-dI ) uJ=0; else uJ=+dI;
-            if ( j >= J-dJ ) uI=0; else uI=+dJ;
-          }
+    // loop through voxels (in all directions)
+    for ( h=0 ; h<H ; h++ ) {
+      for ( i=0 ; i<I ; i++ ) {
+        for ( j=0 ; j<J ; j++ ) {
 
-          // cluster not yet labelled: try to couple to labelled neighbours
-          if ( l(h,i,j)==0 ) {
-            for ( dh=lH ; dh<=uH ; dh++ ) {
-              for ( di=lI ; di<=uJ ; di++ ) {
-                for ( dj=lJ ; dj<=uI ; dj++ ) {
-                  if ( kern(dh+dH,di+dI,dj+dJ) ) {
-                    if ( l(h+dh,i+di,j+dj) ) {
-                      l(h,i,j) = l(h+dh,i+di,j+dj);
-                      goto end;
-                    }
-          }}}}}
-          end: ;
+          // only continue for non-zero voxels
+          if ( !f(h,i,j) ) continue;
 
-          // cluster not yet labelled: create new label
-          if ( l(h,i,j)==0 ) {
-            ilab++;
-            l(h,i,j)  = ilab;
-            inc[ilab] = 1;
-          }
+          // adopt the label of a labelled backward neighbour, link to the others
+          int lab = 0;
 
-          // try to couple neighbours to current label
-          // - not yet labelled -> label neighbour
-          // - labelled         -> link labels
-          for ( dh=lH ; dh<=uH ; dh++ ) {
-            for ( di=lI ; di<=uJ ; di++ ) {
-              for ( dj=lJ ; dj<=uI ; dj++ ) {
-                if ( kern(dh+dH,di+dI,dj+dJ) ) {
-                  if ( f(h+dh,i+di,j+dj) ) {
-                    if ( l(h+dh,i+di,j+dj)==0 )
-                     l(h+dh,i+di,j+dj) = l(h,i,j);
-                    else
-                     _link(lnk,l(h,i,j),l(h+dh,i+di,j+dj));
-          }}}}}
+          for ( size_t n=0 ; n<half.size() ; n+=3 ) {
 
-        }
+            int a = h+half[n], b = i+half[n+1], c = j+half[n+2];
+
+            if ( a<0 or b<0 or b>=I or c<0 or c>=J ) continue;
 
+            int m = l(a,b,c);
+
+            if      ( !m   ) continue;
+            else if ( !lab ) lab = m;
+            else             links.unite(lab, m);
+          }
+
+          // cluster not yet labelled: create new label
+          l(h,i,j) = lab ? lab : links.add();
+        }
       }
     }
+
+    // ---------------------------------------
+    // renumber labels: all links to one label
+    // ---------------------------------------
+
+    // number the linked labels in order of their lowest label
+    // lnk[i] will contain the new label number
+    lnk  = links.flatten();
+    nlab = *std::max_element(lnk.begin(), lnk.end()) + 1;
+
+    // apply renumbering, count the voxels per label
+    size.assign(nlab, 0);
+
+    for ( size_t i=0 ; i<f.size() ; i++ ) {
+      l[i] = lnk[l[i]];
+      size[l[i]]++;
+    }
   }
 
-  // ---------------------------------------
-  // renumber labels: all links to one label
-  // ---------------------------------------
-
-  nlab = 0;
-
-  // loop through assigned labels -> loop through all coupled links
-  // lnk[i] will contain the new label number
-  for ( i=0 ; i<=ilab ; i++ ) {
-    if ( inc[i] ) {
-      ii = i;
-      while ( 1 ) {
-        jj      = lnk[ii];
-        lnk[ii] = nlab;
-        inc[ii] = 0;
-        if ( jj==i ) { break; }
-        ii      = jj;
-      }
-      nlab++;
+  // ---------------------------------------------------
+  // periodic: link labels across the edges of the image
+  // ---------------------------------------------------
+
+  // new label of each label, and its periodic image (in multiples of the shape of the image)
+  std::vector<int> off(3*nlab, 0);
+
+  lnk.resize(nlab);
+
+  std::iota(lnk.begin(), lnk.end(), 0);
+
+  if ( periodic )
+  {
+    // labels and their periodic image (see "OffsetUnionFind")
+    OffsetUnionFind shifts(static_cast<size_t>(nlab));
+
+    // link each voxel near an edge to its neighbours (also across the edge, in a periodic image)
+    linkPeriodic(f, l, offsets, shifts);
+
+    // new label of each label, in order of first appearance (the labels are numbered in order of
+    // first appearance, so the first appearance of a cluster is its lowest label); merge the sizes
+    std::vector<int>    num(nlab, 0);
+    std::vector<size_t> merged(1, 0);
+
+    int n = 0;
+
+    for ( ilab=1 ; ilab<nlab ; ilab++ ) {
+      int r = shifts.find(ilab, &off[3*ilab]);
+      if ( num[r] == 0 ) { num[r] = ++n; merged.push_back(0); }
+      lnk[ilab] = num[r];
+      merged[num[r]] += size[ilab];
     }
+
+    nlab = n+1;
+
+    size.swap(merged);
   }
-  // apply renumbering
-  for ( size_t i=0 ; i<f.size() ; i++ )
-    l[i] = lnk[l[i]];
 
   // --------------------------
   // threshold for cluster size
   // --------------------------
 
+  // remove clusters with too small size, number the others in order (applied below)
   if ( min_size>0 ) {
 
-    // find the size of all clusters
-    for ( i=0 ; i<nlab ; i++ ) {
-      lnk[i] = 0;    // now: size of the cluster with the label
-      inc[i] = 0;    // now: included label (true/false)
-    }
-    for ( size_t i=0 ; i<l.size() ; i++ ) {
-      lnk[l[i]]++;
-      inc[l[i]] = 1;
-    }
-    // remove clusters with too small size
-    for ( i=0 ; i<nlab ; i++ )
-      if ( lnk[i]<min_size )
-        inc[i] = 0;
-
-    // remove clusters with too small size
-    for ( size_t i=0 ; i<l.size() ; i++ )
-      if ( !inc[l[i]] )
-        l[i] = 0;
-
-    // new numbering for the included labels
-    // inc[i] will contain the new cluster numbers,
-    // j-1 will be the number of clusters
+    inc.assign(nlab, 0);
+
     j = 0;
-    for ( i=0 ; i<nlab ; i++ ) {
-      if ( inc[i] ) {
-        inc[i] = j;
-        j++;
-      }
-    }
-    nlab = j;
 
-    // renumber the labels
-    for ( size_t i=0 ; i<l.size() ; i++ )
-      l[i] = inc[l[i]];
+    for ( i=1 ; i<nlab ; i++ )
+      if ( size[i] >= static_cast<size_t>(min_size) )
+        inc[i] = ++j;
 
+    for ( auto &ilab : lnk ) ilab = inc[ilab];
+
+    nlab = j+1;
   }
 
-  // cluster centres: not periodic
-  // -----------------------------
+  // -----------------------------------------------------------------------------------------
+  // apply renumbering, sum the (unwrapped) positions and size of each cluster (in one pass):
+  // [ [ h,i,j , size_feature ] , ... ]
+  // -----------------------------------------------------------------------------------------
 
-  if ( !periodic )
-  {
-    // number of labels
-    nlab = l.max()+1;
+  std::vector<int64_t> sum(4*nlab, 0);
 
-    // allocate matrix to contain the average position and total size:
-    // [ [ h,i,j , size_feature ] , ... ]
-    MatI x = MatI::Zero((size_t)nlab, 4);
-
-    // loop through the image to update the position and size of each label
-    for ( h=0 ; h<H ; h++ ) {
-      for ( i=0 ; i<I ; i++ ) {
-        for ( j=0 ; j<J ; j++ ) {
-          ilab = l(h,i,j);
-          if ( ilab>0 ) {
-            x(ilab,0) += h;
-            x(ilab,1) += i;
-            x(ilab,2) += j;
-            x(ilab,3) += 1;
+  for ( h=0 ; h<H ; h++ ) {
+    for ( i=0 ; i<I ; i++ ) {
+      for ( j=0 ; j<J ; j++ ) {
+        ilab = l(h,i,j);
+        if ( ilab>0 ) {
+          int jlab = lnk[ilab];
+          l(h,i,j) = jlab;
+          if ( jlab>0 ) {
+            sum[4*jlab+0] += h + off[3*ilab+0] * H;
+            sum[4*jlab+1] += i + off[3*ilab+1] * I;
+            sum[4*jlab+2] += j + off[3*ilab+2] * J;
+            sum[4*jlab+3] += 1;
           }
         }
       }
     }
+  }
+
+  // cluster centres: not periodic
+  // -----------------------------
 
+  if ( !periodic )
+  {
     // fill the centres of gravity
     for ( ilab=1 ; ilab<nlab ; ilab++ ) {
-      if ( x(ilab,3)>0 ) {
+      if ( sum[4*ilab+3]>0 ) {
 
-        h = (int)round( (float)x(ilab,0) / (float)x(ilab,3) );
-        i = (int)round( (float)x(ilab,1) / (float)x(ilab,3) );
-        j = (int)round( (float)x(ilab,2) / (float)x(ilab,3) );
+        h = (int)round( (float)sum[4*ilab+0] / (float)sum[4*ilab+3] );
+        i = (int)round( (float)sum[4*ilab+1] / (float)sum[4*ilab+3] );
+        j = (int)round( (float)sum[4*ilab+2] / (float)sum[4*ilab+3] );
 
         if ( h <  0 ) { h = 0; }
         if ( i <  0 ) { i = 0; }
@@ -335,108 +311,23 @@ std::tuple<ArrI,ArrI> clusters(ArrI f, ArrI kern, int min_size, bool periodic)
   // cluster centres: periodic
   // -------------------------
 
+  // the positions are summed above (while renumbering), in the periodic image in which each part of
+  // the cluster is connected to the rest
+
   if ( periodic )
   {
-    int h,i,j,dh,di,dj,ilab,nlab,nlab_;
-
-    // "l_": labels for the non-periodic version image "f"
-    ArrI l_,c_;
-    std::tie(l_,c_) = clusters(f,kern,min_size,false);
-
-    // delete clusters that are also not present in "l"
-    for ( size_t i=0 ; i<f.size() ; i++ )
-      if ( f[i] )
-        if ( !l[i] )
-          l_[i] = 0;
-
-    // number of labels
-    nlab  = l .max()+1;
-    nlab_ = l_.max()+1;
-
-    // matrix to contain the average position and total size:
-    // [ [ h,i,j , size_feature ] , ... ]
-    MatI  x = MatI::Zero((size_t)nlab ,4);
-    // if dx(ilab,ix)==1 than N[ix] is subtracted from the position in averaging
-    MatI dx = MatI::Zero((size_t)nlab_,3);
-
-    // label dependency: which labels in "l_" correspond to which labels in "l"
-    std::vector<int> lnk(nlab_);
-
-    for ( size_t i=0 ; i<l.size() ; i++ )
-      lnk[l_[i]] = l[i];
-
-    // check periodicity: to which sides the clusters are connected
-    // ------------------------------------------------------------
-
-    // i-j plane
-    for ( i=0 ; i<I ; i++ )
-      for ( j=0 ; j<J ; j++ )
-        for ( dh=1 ; dh<=dH ; dh++ )
-          for ( di=0 ; di<=dI ; di++ )
-            for ( dj=0 ; dj<=dJ ; dj++ )
-              if ( i+di<I && j+dj<J )
-                if ( l_(H-1,i,j) )
-                  if ( l(H-1,i,j)==l(H-1+dh,i+di,j+dj) )
-                    dx(l_(H-1,i,j),0) = 1;
-
-    // h-j plane
-    for ( h=0 ; h<H ; h++ )
-      for ( j=0 ; j<J ; j++ )
-        for ( dh=0 ; dh<=dH ; dh++ )
-          for ( di=1 ; di<=dI ; di++ )
-            for ( dj=0 ; dj<=dJ ; dj++ )
-              if ( h+dh<H && j+dj<J )
-                if ( l_(h,I-1,j) )
-                  if ( l(h,I-1,j)==l(h+dh,I-1+di,j+dj) )
-                    dx(l_(h,I-1,j),1) = 1;
-
-    // h-i plane
-    for ( h=0 ; h<H ; h++ )
-      for ( i=0 ; j<I ; j++ )
-        for ( dh=0 ; dh<=dH ; dh++ )
-          for ( di=0 ; di<=dI ; di++ )
-            for ( dj=1 ; dj<=dJ ; dj++ )
-              if ( h+dh<H && i+di<I )
-                if ( l_(h,i,J-1) )
-                  if ( l(h,i,J-1)==l(h+dh,i+di,J-1+dj) )
-                    dx(l_(h,i,J-1),2) = 1;
-
-    // calculate centres
-    // -----------------
-
-    // loop through the image to update the position and size of each label
-    for ( h=0 ; h<H ; h++ ) {
-      for ( i=0 ; i<I ; i++ ) {
-        for ( j=0 ; j<J ; j++ ) {
-          ilab = l_(h,i,j);
-          if ( ilab>0 ) {
-            if ( dx(ilab,0) ) dh = -H; else dh = 0;
-            if ( dx(ilab,1) ) di = -I; else di = 0;
-            if ( dx(ilab,2) ) dj = -J; else dj = 0;
-
-            x(lnk[ilab],0) += h+dh;
-            x(lnk[ilab],1) += i+di;
-            x(lnk[ilab],2) += j+dj;
-            x(lnk[ilab],3) += 1;
-          }
-        }
-      }
-    }
-
     // fill the centres of gravity
+    // (rounded half up: independent of the periodic image in which the cluster is unwrapped)
     for ( ilab=1 ; ilab<nlab ; ilab++ ) {
-      if ( x(ilab,3)>0 ) {
+      if ( sum[4*ilab+3]>0 ) {
 
-        h = (int)round( (float)x(ilab,0) / (float)x(ilab,3) );
-        i = (int)round( (float)x(ilab,1) / (float)x(ilab,3) );
-        j = (int)round( (float)x(ilab,2) / (float)x(ilab,3) );
+        h = (int)std::floor( (double)sum[4*ilab+0] / (double)sum[4*ilab+3] + .5 );
+        i = (int)std::floor( (double)sum[4*ilab+1] / (double)sum[4*ilab+3] + .5 );
+        j = (int)std::floor( (double)sum[4*ilab+2] / (double)sum[4*ilab+3] + .5 );
 
-        while ( h <  0 ) { h += H; }
-        while ( i <  0 ) { i += I; }
-        while ( j <  0 ) { j += J; }
-        while ( h >= H ) { h -= H; }
-        while ( i >= I ) { i -= I; }
-        while ( j >= J ) { j -= J; }
+        h = ( h % H + H ) % H;
+        i = ( i % I + I ) % I;
+        j = ( j % J + J ) % J;
 
         c(h,i,j) = ilab;
       }
@@ -454,56 +345,57 @@ std::tuple<ArrI,ArrI> clusters(ArrI f, ArrI kern, int min_size, bool periodic)
 // wrapper functions
 // =================================================================================================
 
-ArrI clusters(const ArrI &f, const ArrI &kern, int min_size, bool periodic)
+ArrI clusters(const ArrI &f, const ArrI &kern, int min_size, bool periodic, size_t nthreads)
 {
   ArrI clus, cent;
 
-  std::tie(clus, cent) = Private::clusters(f, kern, min_size, periodic);
+  std::tie(clus, cent) = Private::clusters(f, kern, min_size, periodic, nthreads);
 
   return clus;
 }
 
 // -------------------------------------------------------------------------------------------------
 
-ArrI clusters(const ArrI &f, int min_size, bool periodic)
+ArrI clusters(const ArrI &f, int min_size, bool periodic, size_t nthreads)
 {
   ArrI clus, cent;
 
-  std::tie(clus, cent) = Private::clusters(f, kernel(f.rank()), min_size, periodic);
+  std::tie(clus, cent) = Private::clusters(f, kernel(f.rank()), min_size, periodic, nthreads);
 
   return clus;
 }
 
 // -------------------------------------------------------------------------------------------------
 
-ArrI clusters(const ArrI &f, bool periodic)
+ArrI clusters(const ArrI &f, bool periodic, size_t nthreads)
 {
   ArrI clus, cent;
 
-  std::tie(clus, cent) = Private::clusters(f, kernel(f.rank()), 0, periodic);
+  std::tie(clus, cent) = Private::clusters(f, kernel(f.rank()), 0, periodic, nthreads);
 
   return clus;
 }
 
 // -------------------------------------------------------------------------------------------------
 
-std::tuple<ArrI,ArrI> clusterCenters(const ArrI &f, const ArrI &kern, int min_size, bool periodic)
+std::tuple<ArrI,ArrI> clusterCenters(const ArrI &f, const ArrI &kern, int min_size, bool periodic,
+  size_t nthreads)
 {
-  return Private::clusters(f, kern, min_size, periodic);
+  return Private::clusters(f, kern, min_size, periodic, nthreads);
 }
 
 // -------------------------------------------------------------------------------------------------
 
-std::tuple<ArrI,ArrI> clusterCenters(const ArrI &f, int min_size, bool periodic)
+std::tuple<ArrI,ArrI> clusterCenters(const ArrI &f, int min_size, bool periodic, size_t nthreads)
 {
-  return Private::clusters(f, kernel(f.rank()), min_size, periodic);
+  return Private::clusters(f, kernel(f.rank()), min_size, periodic, nthreads);
 }
 
 // -------------------------------------------------------------------------------------------------
 
-std::tuple<ArrI,ArrI> clusterCenters(const ArrI &f, bool periodic)
+std::tuple<ArrI,ArrI> clusterCenters(const ArrI &f, bool periodic, size_t nthreads)
 {
-  return Private::clusters(f, kernel(f.rank()), 0, periodic);
+  return Private::clusters(f, kernel(f.rank()), 0, periodic, nthreads);
 }
 
 // =================================================================================================
@@ -28,52 +28,96 @@ ArrI dilate(ArrI f, ArrI kern, const VecS &iterations, bool periodic)
   if ( f.min() < 0 )
     throw std::runtime_error("Iteration must be specified for each label");
 
-  // apply periodicity
-  f   .setPeriodic(periodic);
-  kern.setPeriodic(periodic);
-
   // initialize output: copy of input
   ArrI out = f;
 
   // change rank to 3 (to simplify implementation)
-  f   .chrank(3);
   kern.chrank(3);
 
-  // mid-point of the kernel
-  VecS mid = kern.midpoint();
+  // non-zero entries of the kernel as offsets relative to its midpoint
+  Private::KernelOffsets offsets(kern);
+
+  const std::vector<int> &d = offsets.all();
+
+  // shape of the image (3-d)
+  int shape[3] = {1, 1, 1};
+
+  for ( size_t i = 0 ; i < f.rank() ; ++i ) shape[i] = f.shape<int>(i);
+
+  int H = shape[0];
+  int I = shape[1];
+  int J = shape[2];
 
-  // region-of-interest
-  int dH = mid[0];
-  int dI = mid[1];
-  int dJ = mid[2];
+  // linear offset of each entry of the kernel (for voxels away from the edges)
+  std::vector<ptrdiff_t> delta;
+
+  for ( size_t k = 0 ; k < d.size() ; k += 3 )
+    delta.push_back( ( static_cast<ptrdiff_t>(d[k]) * I + d[k+1] ) * J + d[k+2] );
+
+  // raw data (row-major storage)
+  int *L = out.data();
+
+  // frontier: voxels labelled in the previous iteration (initially all labelled voxels); only these
+  // can label new voxels, as all neighbours of the other voxels are labelled already
+  std::vector<size_t> front;
+  std::vector<size_t> next;
+
+  for ( size_t k = 0 ; k < out.size() ; ++k )
+    if ( L[k] > 0 and iterations[L[k]] > 0 )
+      front.push_back(k);
 
   // loop through iterations
-  for ( size_t iter = 0 ; iter < cppmat::max(iterations) ; ++iter )
+  for ( size_t iter = 0 ; iter < cppmat::max(iterations) and ! front.empty() ; ++iter )
   {
-    // loop through all voxel
-    for ( int h = 0 ; h < f.shape<int>(0) ; ++h ) {
-      for ( int i = 0 ; i < f.shape<int>(1) ; ++i ) {
-        for ( int j = 0 ; j < f.shape<int>(2) ; ++j ) {
-          // label over the current voxel
-          int ilab = out(h,i,j);
-          // proceed:
-          // - for non-zero label
-          // - if the number of iterations for this label has not been exceeded
-          if ( ilab>0 and iterations[ilab]>iter )
-            // loop through the kernel
-            for ( int dh = -dH ; dh <= dH ; ++dh )
-              for ( int di = -dI ; di <= dI ; ++di )
-                for ( int dj = -dJ ; dj <= dJ ; ++dj )
-                  // check to dilate for non-zero kernel value
-                  if ( kern(dh+dH,di+dI,dj+dJ) )
-                    if ( out.inBounds(h+dh,i+di,j+dj) )
-                      if ( !out(h+dh,i+di,j+dj) )
-                        out(h+dh,i+di,j+dj) = -1*ilab;
+    next.clear();
+
+    // label the unlabelled neighbours of the frontier; a voxel is labelled by the first voxel (in
+    // raster order) of which it is a neighbour, as the frontier is sorted
+    for ( auto &k : front )
+    {
+      int ilab = L[k];
+
+      // - the number of iterations for this label has been exceeded
+      if ( iterations[ilab] <= iter ) continue;
+
+      int h = static_cast<int>( k / ( static_cast<size_t>(I) * J ) );
+      int i = static_cast<int>( ( k / J ) % I );
+      int j = static_cast<int>( k % J );
+
+      bool interior = ( h >= offsets.mid()[0] and h < H - offsets.mid()[0] and
+                        i >= offsets.mid()[1] and i < I - offsets.mid()[1] and
+                        j >= offsets.mid()[2] and j < J - offsets.mid()[2] );
+
+      // - loop through the non-zero entries of the kernel
+      for ( size_t n = 0 ; n < delta.size() ; ++n )
+      {
+        size_t m;
+
+        if ( interior ) {
+          m = static_cast<size_t>( static_cast<ptrdiff_t>(k) + delta[n] );
+        }
+        else {
+          int y[3] = {h + d[3*n], i + d[3*n+1], j + d[3*n+2]};
+          bool in  = true;
+          for ( size_t ax = 0 ; ax < 3 ; ++ax ) {
+            if      ( periodic ) y[ax] = ( y[ax] % shape[ax] + shape[ax] ) % shape[ax];
+            else if ( y[ax] < 0 or y[ax] >= shape[ax] ) in = false;
+          }
+          if ( ! in ) continue;
+          m = ( static_cast<size_t>(y[0]) * I + y[1] ) * J + y[2];
+        }
+
+        if ( ! L[m] ) {
+          L[m] = ilab;
+          next.push_back(m);
         }
       }
     }
-    // accept all new labels (which were stored as negative)
-    out = out.abs();
+
+    // new frontier, in raster order
+    std::sort(next.begin(), next.end());
+
+    front.swap(next);
   }
 
   return out;
@@ -0,0 +1,252 @@
+/* =================================================================================================
+
+(c - GPLv3) T.W.J. de Geus (Tom) | tom@geus.me | www.geus.me | github.com/tdegeus/GooseEYE
+
+================================================================================================= */
+
+#ifndef GOOSEEYE_DISTANCE_HPP
+#define GOOSEEYE_DISTANCE_HPP
+
+// =================================================================================================
+
+#include "GooseEYE.h"
+
+// =================================================================================================
+
+namespace GooseEYE {
+
+// =================================================================================================
+// core functions: called by wrappers below
+// =================================================================================================
+
+namespace Private {
+
+// -------------------------------------------------------------------------------------------------
+// Squared Euclidean distance transform along one line (Felzenszwalb-Huttenlocher): the lower
+// envelope of the parabolas "(p-q)^2 + g[q]" of the samples "q" with finite "g[q]", evaluated at
+// each "p". Periodic: the samples are repeated on either side of the line (the nearest sample is
+// never more than one period away). Optionally the feature "fg[q]" (e.g. the nearest voxel) of the
+// parabola that is the minimum is selected at each "p". The workspace is reused between lines.
+// -------------------------------------------------------------------------------------------------
+
+class DistanceLine
+{
+private:
+
+  std::vector<double> mV; // position of the parabolas of the lower envelope
+  std::vector<double> mG; // value at the vertex of the parabolas of the lower envelope
+  std::vector<double> mZ; // boundaries between the parabolas of the lower envelope
+  std::vector<size_t> mF; // feature of the parabolas of the lower envelope
+
+public:
+
+  // transform "n" samples of "g" (stored with stride "stride"), written to "out" (same storage);
+  // if "fg" is given: the features of the samples, of which the selected feature is written to
+  // "fout" (same storage)
+  void transform(const double *g, double *out, size_t n, size_t stride, bool periodic,
+    const size_t *fg=nullptr, size_t *fout=nullptr);
+};
+
+// -------------------------------------------------------------------------------------------------
+
+inline void DistanceLine::transform(const double *g, double *out, size_t n, size_t stride,
+  bool periodic, const size_t *fg, size_t *fout)
+{
+  const double inf = std::numeric_limits<double>::infinity();
+
+  mV.clear();
+  mG.clear();
+  mF.clear();
+  mZ.assign(1, -inf);
+
+  // add the parabola of sample "g" at "q" (in increasing order of "q") to the lower envelope
+  auto add = [&](double q, double gq, size_t fq)
+  {
+    while ( ! mV.empty() )
+    {
+      double v = mV.back();
+      double s = ( ( gq + q * q ) - ( mG.back() + v * v ) ) / ( 2. * ( q - v ) );
+
+      if ( s > mZ.back() ) { mZ.push_back(s); break; }
+
+      mV.pop_back();
+      mG.pop_back();
+      mF.pop_back();
+      mZ.pop_back();
+
+      if ( mV.empty() ) mZ.assign(1, -inf);
+    }
+
+    mV.push_back(q);
+    mG.push_back(gq);
+    mF.push_back(fq);
+  };
+
+  // lower envelope: samples of the line, periodic: repeated on either side
+  int N  = static_cast<int>(n);
+  int c0 = periodic ? -1 : 0;
+  int c1 = periodic ? +1 : 0;
+
+  for ( int c = c0 ; c <= c1 ; ++c )
+    for ( int q = 0 ; q < N ; ++q )
+      if ( g[q*stride] < inf )
+        add(static_cast<double>(q + c * N), g[q*stride], fg ? fg[q*stride] : 0);
+
+  // no samples: infinite distance (the features are left unchanged)
+  if ( mV.empty() ) {
+    for ( size_t p = 0 ; p < n ; ++p ) out[p*stride] = inf;
+    return;
+  }
+
+  // evaluate the lower envelope
+  mZ.push_back(inf);
+
+  size_t k = 0;
+
+  for ( int p = 0 ; p < N ; ++p ) {
+    while ( mZ[k+1] < p ) ++k;
+    double d = static_cast<double>(p) - mV[k];
+    out[p*stride] = d * d + mG[k];
+    if ( fout ) fout[p*stride] = mF[k];
+  }
+}
+
+// -------------------------------------------------------------------------------------------------
+// Squared Euclidean distance of each voxel to the nearest non-zero voxel of "f" (infinite if there
+// is none): the one-dimensional transform is applied along each axis in turn. If "feature" is
+// given: the linear index of the nearest non-zero voxel (undefined if there is none).
+// -------------------------------------------------------------------------------------------------
+
+inline ArrD distance2(const ArrI &f, bool periodic, std::vector<size_t> *feature=nullptr)
+{
+  // check
+  if ( f.rank() > 3 )
+    throw std::runtime_error("GooseEYE::distance - rank of 'f' must be <= 3");
+
+  // shape of the image (3-d)
+  size_t shape[3] = {1, 1, 1};
+
+  for ( size_t i = 0 ; i < f.rank() ; ++i ) shape[i] = f.shape(i);
+
+  // initialize: zero at the non-zero voxels (their own feature), infinite elsewhere
+  ArrD out = ArrD::Zero(f.shape());
+
+  for ( size_t k = 0 ; k < f.size() ; ++k )
+    if ( ! f[k] )
+      out[k] = std::numeric_limits<double>::infinity();
+
+  size_t *I = nullptr;
+
+  if ( feature ) {
+    feature->resize(f.size());
+    std::iota(feature->begin(), feature->end(), 0);
+    I = feature->data();
+  }
+
+  // transform along each axis (a line of the transform is the input of the next axis)
+  DistanceLine line;
+  double      *D = out.data();
+
+  size_t stride[3] = {shape[1] * shape[2], shape[2], 1};
+
+  for ( size_t ax = 0 ; ax < 3 ; ++ax )
+  {
+    if ( shape[ax] == 1 ) continue;
+
+    for ( size_t k = 0 ; k < out.size() ; ++k ) {
+      if ( ( k / stride[ax] ) % shape[ax] != 0 ) continue;
+      if ( I ) line.transform(D + k, D + k, shape[ax], stride[ax], periodic, I + k, I + k);
+      else     line.transform(D + k, D + k, shape[ax], stride[ax], periodic);
+    }
+  }
+
+  return out;
+}
+
+// -------------------------------------------------------------------------------------------------
+
+} // namespace Private
+
+// =================================================================================================
+// wrapper functions
+// =================================================================================================
+
+inline
+ArrD distance(const ArrI &f, bool periodic)
+{
+  ArrD out = Private::distance2(f, periodic);
+
+  for ( size_t k = 0 ; k < out.size() ; ++k ) out[k] = std::sqrt(out[k]);
+
+  return out;
+}
+
+// -------------------------------------------------------------------------------------------------
+
+inline
+std::tuple<ArrI,ArrD> featureTransform(const ArrI &f, bool periodic)
+{
+  std::vector<size_t> feature;
+
+  ArrD dist = Private::distance2(f, periodic, &feature);
+  ArrI lab  = ArrI::Zero(f.shape());
+
+  for ( size_t k = 0 ; k < f.size() ; ++k ) {
+    if ( std::isinf(dist[k]) ) continue;
+    lab [k] = f[feature[k]];
+    dist[k] = std::sqrt(dist[k]);
+  }
+
+  return std::make_tuple(lab, dist);
+}
+
+// -------------------------------------------------------------------------------------------------
+
+inline
+ArrI dilateRadius(const ArrI &f, const std::vector<double> &radius, bool periodic)
+{
+  // check input
+  if ( static_cast<size_t>(f.max()+1) != radius.size() )
+    throw std::runtime_error("GooseEYE::dilateRadius - radius must be specified for each label");
+
+  if ( f.min() < 0 )
+    throw std::runtime_error("GooseEYE::dilateRadius - labels must be non-negative");
+
+  for ( auto &r : radius )
+    if ( r < 0. )
+      throw std::runtime_error("GooseEYE::dilateRadius - 'radius' must be non-negative");
+
+  // nearest non-zero voxel, and the (squared) distance to it
+  std::vector<size_t> feature;
+
+  ArrD d2  = Private::distance2(f, periodic, &feature);
+  ArrI out = ArrI::Zero(f.shape());
+
+  // assign each voxel to the label of the nearest non-zero voxel, if within its radius
+  for ( size_t k = 0 ; k < out.size() ; ++k ) {
+    if ( std::isinf(d2[k]) ) continue;
+    int ilab = f[feature[k]];
+    if ( d2[k] <= radius[ilab] * radius[ilab] ) out[k] = ilab;
+  }
+
+  return out;
+}
+
+// -------------------------------------------------------------------------------------------------
+
+inline
+ArrI dilateRadius(const ArrI &f, double radius, bool periodic)
+{
+  if ( f.min() < 0 )
+    throw std::runtime_error("GooseEYE::dilateRadius - labels must be non-negative");
+
+  return dilateRadius(f, std::vector<double>(f.max()+1, radius), periodic);
+}
+
+// =================================================================================================
+
+} // namespace ...
+
+// =================================================================================================
+
+#endif
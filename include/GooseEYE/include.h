@@ -14,6 +14,8 @@
 #include <math.h>
 #include <assert.h>
 #include <cstdlib>
+#include <cstddef>
+#include <cstdint>
 #include <vector>
 #include <string>
 #include <memory>
@@ -22,6 +24,10 @@
 #include <numeric>
 #include <limits>
 #include <algorithm>
+#include <type_traits>
+#include <atomic>
+#include <thread>
+#include <exception>
 #include <cppmat/cppmat.h>
 
 // =================================================================================================
@@ -57,6 +63,8 @@ namespace GooseEYE
 {
   typedef cppmat::array <double> ArrD;
   typedef cppmat::array <int>    ArrI;
+  typedef cppmat::array <uint16_t> ArrU16;
+  typedef cppmat::array <uint32_t> ArrU32;
   typedef cppmat::matrix<double> MatD;
   typedef cppmat::matrix<int>    MatI;
   typedef std::vector<size_t>    VecS;
@@ -74,9 +82,24 @@ struct Stat {
     W2,
     W2c,
     L,
+    chordLength,
   };
 };
 
+// -------------------------------------------------------------------------------------------------
+
+// enumerate used in "path"
+namespace GooseEYE
+{
+  struct Path {
+    enum Value {
+      Bresenham,
+      actual,
+      full,
+    };
+  };
+}
+
 // =================================================================================================
 
 #endif
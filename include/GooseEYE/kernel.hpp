@@ -54,6 +54,12 @@ ArrI kernel(size_t ndim, std::string mode)
     }
   }
 
+  if ( mode=="full" )
+  {
+    if ( ndim >= 1 and ndim <= 3 )
+      return ArrI::Ones(VecS(ndim, 3));
+  }
+
   throw std::runtime_error("Unknown ndim/mode");
 }
 
@@ -0,0 +1,104 @@
+/* =================================================================================================
+
+(c - GPLv3) T.W.J. de Geus (Tom) | tom@geus.me | www.geus.me | github.com/tdegeus/GooseEYE
+
+================================================================================================= */
+
+#ifndef GOOSEEYE_KERNEL_OFFSETS_HPP
+#define GOOSEEYE_KERNEL_OFFSETS_HPP
+
+// =================================================================================================
+
+#include "GooseEYE.h"
+
+// =================================================================================================
+
+namespace GooseEYE {
+namespace Private {
+
+// -------------------------------------------------------------------------------------------------
+// Kernel stored as the list of offsets of its non-zero entries relative to its midpoint (excluding
+// the midpoint itself), such that a neighbourhood is visited without testing all entries of the
+// kernel. The offsets are in the order of the (row-major) storage of the kernel. The backward half
+// contains each offset "d" for which "kern(d)" or "kern(-d)" is non-zero that precedes the midpoint
+// in a raster scan: linking each voxel to these neighbours connects all neighbours of the kernel.
+// -------------------------------------------------------------------------------------------------
+
+class KernelOffsets
+{
+private:
+
+  std::vector<int> mAll;     // non-zero entries: [ [dh, di, dj], ... ]
+  std::vector<int> mHalf;    // backward half of the (symmetric) neighbourhood: [ [dh, di, dj], ... ]
+  int              mMid[3];  // midpoint of the kernel (half of its shape)
+
+public:
+
+  // constructors
+  KernelOffsets() = default;
+  explicit KernelOffsets(const ArrI &kern);
+
+  // number of non-zero entries (excluding the midpoint), number of backward neighbours
+  size_t size () const { return mAll .size() / 3; }
+  size_t nhalf() const { return mHalf.size() / 3; }
+
+  // offsets: [ [dh, di, dj], ... ]
+  const std::vector<int>& all () const { return mAll;  }
+  const std::vector<int>& half() const { return mHalf; }
+
+  // midpoint of the kernel
+  const int* mid() const { return mMid; }
+};
+
+// =================================================================================================
+// constructor: list the offsets of a kernel (of rank <= 3, odd shaped)
+// =================================================================================================
+
+inline
+KernelOffsets::KernelOffsets(const ArrI &kern)
+{
+  // shape of the kernel (3-d)
+  int shape[3] = {1, 1, 1};
+
+  if ( kern.rank() > 3 )
+    throw std::runtime_error("GooseEYE::Private::KernelOffsets - rank of 'kernel' must be <= 3");
+
+  for ( size_t i = 0 ; i < kern.rank() ; ++i ) shape[i] = kern.shape<int>(i);
+
+  // check
+  for ( size_t i = 0 ; i < 3 ; ++i )
+    if ( shape[i] % 2 == 0 )
+      throw std::runtime_error("GooseEYE::Private::KernelOffsets - 'kernel' must be odd shaped");
+
+  // midpoint
+  for ( size_t i = 0 ; i < 3 ; ++i ) mMid[i] = ( shape[i] - 1 ) / 2;
+
+  // raw data (row-major storage), and the linear index of the midpoint
+  const int *K   = kern.data();
+  size_t     mid = kern.size() / 2;
+
+  // list the offsets
+  for ( size_t k = 0 ; k < kern.size() ; ++k )
+  {
+    int d[3] = {
+      static_cast<int>( k / ( shape[1] * shape[2] ) ) - mMid[0],
+      static_cast<int>( ( k / shape[2] ) % shape[1] ) - mMid[1],
+      static_cast<int>( k % shape[2] )                - mMid[2],
+    };
+
+    // - non-zero entries
+    if ( K[k] and k != mid ) mAll.insert(mAll.end(), d, d+3);
+
+    // - backward half of the symmetric neighbourhood ("-d" has the mirrored linear index)
+    if ( k < mid and ( K[k] or K[kern.size()-1-k] ) ) mHalf.insert(mHalf.end(), d, d+3);
+  }
+}
+
+// =================================================================================================
+
+} // namespace Private
+} // namespace GooseEYE
+
+// =================================================================================================
+
+#endif
@@ -0,0 +1,66 @@
+/* =================================================================================================
+
+(c - GPLv3) T.W.J. de Geus (Tom) | tom@geus.me | www.geus.me | github.com/tdegeus/GooseEYE
+
+================================================================================================= */
+
+#ifndef GOOSEEYE_LABELS_HPP
+#define GOOSEEYE_LABELS_HPP
+
+// =================================================================================================
+
+#include "GooseEYE.h"
+
+// =================================================================================================
+
+namespace GooseEYE {
+
+// =================================================================================================
+// number of bits needed to store the labels of a label image: 16 or 32 (the labels are unsigned)
+// =================================================================================================
+
+inline size_t labelBits(const ArrI &labels)
+{
+  int lo = 0;
+  int hi = 0;
+
+  for ( size_t i = 0 ; i < labels.size() ; ++i ) {
+    lo = std::min(lo, labels[i]);
+    hi = std::max(hi, labels[i]);
+  }
+
+  if ( lo < 0 )
+    throw std::runtime_error("GooseEYE::labelBits - labels must be non-negative");
+
+  if ( hi <= static_cast<int>(std::numeric_limits<uint16_t>::max()) ) return 16;
+
+  return 32;
+}
+
+// =================================================================================================
+// label image stored as "uint16_t" or "uint32_t"
+// =================================================================================================
+
+template<class T>
+cppmat::array<T> compactLabels(const ArrI &labels)
+{
+  static_assert(std::is_unsigned<T>::value, "GooseEYE::compactLabels - unsigned type required");
+
+  if ( sizeof(T) * 8 < labelBits(labels) )
+    throw std::runtime_error("GooseEYE::compactLabels - labels exceed the range of the type");
+
+  cppmat::array<T> out(labels.shape());
+
+  for ( size_t i = 0 ; i < labels.size() ; ++i )
+    out[i] = static_cast<T>(labels[i]);
+
+  return out;
+}
+
+// =================================================================================================
+
+} // namespace ...
+
+// =================================================================================================
+
+#endif
@@ -0,0 +1,85 @@
+/* =================================================================================================
+
+(c - GPLv3) T.W.J. de Geus (Tom) | tom@geus.me | www.geus.me | github.com/tdegeus/GooseEYE
+
+================================================================================================= */
+
+#ifndef GOOSEEYE_PARALLEL_HPP
+#define GOOSEEYE_PARALLEL_HPP
+
+// =================================================================================================
+
+#include "GooseEYE.h"
+
+// =================================================================================================
+
+namespace GooseEYE {
+namespace Private {
+
+// =================================================================================================
+// number of threads to use: "0" -> number of concurrent threads supported by the hardware
+// =================================================================================================
+
+inline size_t threads(size_t nthreads)
+{
+  if ( nthreads == 0 ) nthreads = std::thread::hardware_concurrency();
+
+  return std::max(nthreads, static_cast<size_t>(1));
+}
+
+// =================================================================================================
+// Call "func(itask, ithread)" for each "itask = 0, ..., ntask-1" using "nthreads" threads (with
+// "ithread = 0, ..., nthreads-1"). Tasks are handed out one-by-one from a shared counter, such that
+// threads that finish early take over the remaining work: tasks of very different cost are
+// balanced dynamically. The first exception thrown by any task is re-thrown.
+// =================================================================================================
+
+template<class Func>
+inline void parallel_for(size_t ntask, size_t nthreads, Func func)
+{
+  nthreads = std::min(threads(nthreads), std::max(ntask, static_cast<size_t>(1)));
+
+  // serial: avoid any overhead
+  if ( nthreads == 1 ) {
+    for ( size_t itask = 0 ; itask < ntask ; ++itask ) func(itask, 0);
+    return;
+  }
+
+  // next task to hand out, and exception thrown by each thread (if any)
+  std::atomic<size_t>             next(0);
+  std::vector<std::exception_ptr> error(nthreads);
+
+  // worker: take the next task until all tasks are done (or one of the workers failed)
+  auto work = [&](size_t ithread) {
+    try {
+      for ( size_t itask = next++ ; itask < ntask ; itask = next++ ) func(itask, ithread);
+    }
+    catch (...) {
+      error[ithread] = std::current_exception();
+      next = ntask;
+    }
+  };
+
+  // run, the current thread is one of the workers
+  std::vector<std::thread> pool;
+
+  for ( size_t ithread = 1 ; ithread < nthreads ; ++ithread ) pool.emplace_back(work, ithread);
+
+  work(0);
+
+  for ( auto &thread : pool ) thread.join();
+
+  // re-throw
+  for ( auto &e : error )
+    if ( e )
+      std::rethrow_exception(e);
+}
+
+// =================================================================================================
+
+} // namespace Private
+} // namespace GooseEYE
+
+// =================================================================================================
+
+#endif
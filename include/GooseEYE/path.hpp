@@ -14,183 +14,312 @@
 // =================================================================================================
 
 namespace GooseEYE {
+namespace Private {
 
 // =================================================================================================
-// pixel/voxel path between two points "xa" and "xb"
+// Bresenham path between "xa" and "xb" (both 3-d, unused dimensions zero): "func(x)" for each voxel
+// see http://www.luberth.com/plotter/line3d.c.txt.html
 // =================================================================================================
 
-MatI path(const VecI &xa, const VecI &xb, std::string mode)
+template<class Func>
+inline void bresenham(const int xa[3], const int xb[3], Func func)
 {
-  std::transform(mode.begin(), mode.end(), mode.begin(), ::tolower);
+  int a[3],s[3],x[3],d[3],in[2],j,i,iin;
 
-  int ndim = static_cast<int>(xa.size());
+  // calculate:
+  // absolute distance
+  // sign of the distance (can be -1/+1 or 0)
+  // current position (temporary value)
+  for ( i=0; i<3; i++) {
+    a[i] = std::abs(xb[i]-xa[i]) << 1;
+    s[i] = SIGN    (xb[i]-xa[i]);
+    x[i] = xa[i];
+    d[i] = 0;
+  }
 
-  if ( xa.size() != xb.size() )
-    throw std::runtime_error("'xa' and 'xb' must have the same dimension");
+  // determine which direction is dominant
+  for ( j=0; j<3; j++ ) {
+    // set the remaining directions
+    iin = 0;
+    for ( i=0; i<3; i++ ) {
+      if ( i!=j ) {
+        in[iin] = i;
+        iin    += 1;
+      }
+    }
+    // determine if the current direction is dominant
+    if ( a[j] >= std::max(a[in[0]],a[in[1]]) )
+      break;
+  }
 
-  if ( ndim < 1 or ndim > 3 )
-    throw std::runtime_error("Only allowed in 1, 2, or 3 dimensions");
+  // set increment in non-dominant directions
+  for ( i=0; i<2; i++)
+    d[in[i]] = a[in[i]]-(a[j]>>1);
 
-    std::vector<int> ret;
+  // loop until "x" coincides with "xb"
+  while ( 1 ) {
+    // add current voxel to path
+    func(static_cast<const int*>(x));
+    // check convergence
+    if ( x[j]==xb[j] )
+      return;
+    // check increment in other directions
+    for ( i=0; i<2; i++ ) {
+      if ( d[in[i]]>=0 ) {
+        x[in[i]] += s[in[i]];
+        d[in[i]] -= a[j];
+      }
+    }
+    // increment
+    x[j] += s[j];
+    for ( i=0; i<2; i++ )
+      d[in[i]] += a[in[i]];
+  }
+}
+
+// =================================================================================================
+// path between "xa" and "xb" (both 3-d, unused dimensions zero) that includes all voxels crossed
+// by the line: "func(x)" for each voxel
+// full: store all face crossings (also when the line passes through an edge or a corner)
+//
+// The line crosses its "m"-th voxel face along dimension "i" at "t = (2*m+1) / (2*|v[i]|)", with
+// "v = xb - xa" (and "0 <= t <= 1"). The next crossing is thus found by comparing
+// "(2*m[i]+1) * |v[j]|" to "(2*m[j]+1) * |v[i]|" in integer arithmetic: ties (the line passes
+// through an edge or a corner) are exact, and the dimensions involved are stepped in ascending order.
+// =================================================================================================
+
+template<bool full, class Func>
+inline void traversal(const int xa[3], const int xb[3], Func func)
+{
+  // current voxel, absolute slope, sign of the slope, number of faces crossed along each dimension
+  int       x[3], s[3];
+  long long v[3], m[3];
+
+  for ( size_t i = 0 ; i < 3 ; ++i ) {
+    x[i] = xa[i];
+    v[i] = std::abs(xb[i]-xa[i]);
+    s[i] = SIGN    (xb[i]-xa[i]);
+    m[i] = 0;
+  }
+
+  // store origin
+  func(static_cast<const int*>(x));
 
-  if ( mode=="bresenham" )
+  // starting from "xa" loop to "xb"
+  while ( x[0] != xb[0] or x[1] != xb[1] or x[2] != xb[2] )
   {
-    // see http://www.luberth.com/plotter/line3d.c.txt.html
-    int a[3],s[3],x[3],d[3],in[2],j,i,iin,nnz=0;
+    // - find the nearest face crossing along the line (only dimensions with non-zero slope)
+    int imin = -1;
 
-    // set defaults
-    for ( i=0; i<3; i++ ) {
-      a[i] = 1;
-      s[i] = 0;
-      x[i] = 0;
-      d[i] = 0;
-    }
+    for ( int i = 0 ; i < 3 ; ++i )
+      if ( v[i] )
+        if ( imin < 0 or (2*m[i]+1) * v[imin] < (2*m[imin]+1) * v[i] )
+          imin = i;
 
-    // calculate:
-    // absolute distance, set to "1" if the distance is zero
-    // sign of the distance (can be -1/+1 or 0)
-    // current position (temporary value)
-    for ( i=0; i<ndim; i++) {
-      a[i] = std::abs(xb[i]-xa[i]) << 1;
-      s[i] = SIGN    (xb[i]-xa[i]);
-      x[i] = xa[i];
-    }
+    // - dimensions that cross a face at the same point
+    bool step[3];
 
-    // determine which direction is dominant
-    for ( j=0; j<3; j++ ) {
-      // set the remaining directions
-      iin = 0;
-      for ( i=0; i<3; i++ ) {
-        if ( i!=j ) {
-          in[iin] = i;
-          iin    += 1;
-        }
-      }
-      // determine if the current direction is dominant
-      if ( a[j] >= std::max(a[in[0]],a[in[1]]) )
-        break;
-    }
+    for ( int i = 0 ; i < 3 ; ++i )
+      step[i] = v[i] and (2*m[i]+1) * v[imin] == (2*m[imin]+1) * v[i];
 
-    // set increment in non-dominant directions
-    for ( i=0; i<2; i++)
-      d[in[i]] = a[in[i]]-(a[j]>>1);
-    // loop until "x" coincides with "xb"
-    while ( 1 ) {
-      // add current voxel to path
-      for ( i=0; i<ndim; i++)
-        ret.push_back(x[i]);
-      // update voxel counter
-      nnz += 1;
-      // check convergence
-      if ( x[j]==xb[j] ) {
-        return MatI::Copy(static_cast<size_t>(nnz), static_cast<size_t>(ndim), &ret[0]);
+    // - proceed in each of these dimensions, store all face crossings ("full")
+    for ( int i = 0 ; i < 3 ; ++i ) {
+      if ( step[i] ) {
+        x[i] += s[i];
+        m[i] += 1;
+        if ( full ) func(static_cast<const int*>(x));
       }
-      // check increment in other directions
-      for ( i=0; i<2; i++ ) {
-        if ( d[in[i]]>=0 ) {
-          x[in[i]] += s[in[i]];
-          d[in[i]] -= a[j];
-        }
-      }
-      // increment
-      x[j] += s[j];
-      for ( i=0; i<2; i++ )
-        d[in[i]] += a[in[i]];
     }
+
+    // - store only the next voxel ("actual")
+    if ( ! full ) func(static_cast<const int*>(x));
   }
+}
+
+// =================================================================================================
+
+} // namespace Private
 
-  if ( mode=="actual" || mode=="full" )
+// =================================================================================================
+// convert path-mode to enumerate (case insensitive): "Bresenham", "actual", or "full"
+// =================================================================================================
+
+Path::Value pathMode(std::string mode)
+{
+  std::transform(mode.begin(), mode.end(), mode.begin(), ::tolower);
+
+  if ( mode == "bresenham" ) return Path::Bresenham;
+  if ( mode == "actual"    ) return Path::actual;
+  if ( mode == "full"      ) return Path::full;
+
+  throw std::out_of_range("Unknown 'mode'");
+}
+
+// =================================================================================================
+// pixel/voxel path between two points "xa" and "xb", without allocation: "func(x)" is called for
+// each voxel along the path, with "x" the voxel's position
+// N.B. "xa", "xb", and "x" are 3-d: unused dimensions are zero
+// =================================================================================================
+
+template<Path::Value mode, class Func>
+inline void pathVisit(const int xa[3], const int xb[3], Func func)
+{
+  switch ( mode )
   {
-    // position, slope, (length to) next intersection
-    double x[3],v[3],t[3],next[3],sign[3];
-    int isign[3];
-    // active dimensions (for in-plane paths dimension have to be skipped
-    // to avoid dividing by zero)
-    int in[3],iin,nin;
-    // path of the current voxel
-    int cindex[3];
-    int nnz = 1;
-    // counters
-    int i,imin,n;
-
-    // set the direction coefficient in all dimensions; if it is zero this
-    // dimension is excluded from further analysis (i.e. in-plane growth)
-    nin = 0;
-    for ( i=0 ; i<ndim ; i++ ) {
-      // set origin, store to output array; initiate the position
-      cindex[i] = xa[i];
-      ret.push_back(cindex[i]);
-      // initiate position, set slope
-      x[i] = (double)(xa[i]);
-      v[i] = (double)(xb[i]-xa[i]);
-      // non-zero slope: calculate the sign and the next intersection
-      // with a voxel's edges, and update the list to include this dimension
-      // in the further analysis
-      if ( v[i] ) {
-        sign[i]  = v[i]/fabs(v[i]);
-        isign[i] = (int)sign[i];
-        next[i]  = sign[i]*0.5;
-        in[nin]  = i;
-        nin++;
-      }
-    }
+    case Path::Bresenham: Private::bresenham       (xa, xb, func); return;
+    case Path::actual   : Private::traversal<false>(xa, xb, func); return;
+    case Path::full     : Private::traversal<true >(xa, xb, func); return;
+  }
+}
 
-    // starting from "xa" loop to "xb"
-    while ( 1 ) {
+// -------------------------------------------------------------------------------------------------
 
-      // find translation coefficient "t" for each next intersection
-      // (only include dimensions with non-zero slope)
-      for ( iin=0 ; iin<nin ; iin++ ) {
-        i      = in[iin];
-        t[iin] = (next[i]-x[i])/v[i];
-      }
-      // find the minimum "t": the intersection which is closet along the line
-      // from the current position -> proceed in this direction
-      imin = 0;
-      for ( iin=1 ; iin<nin ; iin++ )
-        if ( t[iin]<t[imin] )
-          imin = iin;
-
-      // update path: proceed in dimension of minimum "t"
-      // note: if dimensions have equal "t" -> proceed in each dimension
-      for ( iin=0 ; iin<nin ; iin++ ) {
-        if ( fabs(t[iin]-t[imin])<1.e-6 ) {
-          cindex[in[iin]] += isign[in[iin]];
-          next[in[iin]]   += sign[in[iin]];
-          // store all the face crossings ("mode")
-          if ( mode=="full" ) {
-            for ( i=0 ; i<ndim ; i++ )
-              ret.push_back(cindex[i]);
-            nnz++;
-          }
-        }
-      }
-      // store only the next voxel ("actual")
-      if ( mode=="actual" ) {
-        for ( i=0 ; i<ndim ; i++ )
-          ret.push_back(cindex[i]);
-        nnz++;
-      }
-      // update position, and current path
-      for ( i=0 ; i<ndim ; i++ )
-        x[i] = xa[i]+v[i]*t[imin];
-
-      // check convergence: stop when "xb" is reached
-      n = 0;
-      for ( i=0 ; i<ndim; i++ )
-        if ( cindex[i]==xb[i] )
-          n++;
-      if ( n==ndim )
-        break;
+template<class Func>
+inline void pathVisit(Path::Value mode, const int xa[3], const int xb[3], Func func)
+{
+  switch ( mode )
+  {
+    case Path::Bresenham: pathVisit<Path::Bresenham>(xa, xb, func); return;
+    case Path::actual   : pathVisit<Path::actual   >(xa, xb, func); return;
+    case Path::full     : pathVisit<Path::full     >(xa, xb, func); return;
+  }
 
-    }
+  throw std::out_of_range("Unknown 'mode'");
+}
 
-    return MatI::Copy(static_cast<size_t>(nnz), static_cast<size_t>(ndim), &ret[0]);
+// =================================================================================================
+// pixel/voxel path between two points "xa" and "xb", written to a caller-provided buffer "out"
+// (row-major: "ndim" coordinates per voxel) of at most "capacity" voxels. Returns the number of
+// voxels in the path: if it exceeds "capacity" the path is truncated, and the call can be repeated
+// with a larger buffer.
+// N.B. "xa" and "xb" are 3-d: set unused dimensions to zero
+// =================================================================================================
+
+template<Path::Value mode>
+inline size_t pathFill(const int xa[3], const int xb[3], size_t ndim, int *out, size_t capacity)
+{
+  size_t n = 0;
+
+  pathVisit<mode>(xa, xb, [&](const int *x) {
+    if ( n < capacity )
+      for ( size_t i = 0 ; i < ndim ; ++i )
+        out[n*ndim+i] = x[i];
+    ++n;
+  });
+
+  return n;
+}
+
+// -------------------------------------------------------------------------------------------------
+
+size_t pathFill(Path::Value mode, const int xa[3], const int xb[3], size_t ndim, int *out,
+  size_t capacity)
+{
+  switch ( mode )
+  {
+    case Path::Bresenham: return pathFill<Path::Bresenham>(xa, xb, ndim, out, capacity);
+    case Path::actual   : return pathFill<Path::actual   >(xa, xb, ndim, out, capacity);
+    case Path::full     : return pathFill<Path::full     >(xa, xb, ndim, out, capacity);
   }
 
   throw std::out_of_range("Unknown 'mode'");
 }
 
+// =================================================================================================
+// pixel/voxel path between two points "xa" and "xb"
+// =================================================================================================
+
+MatI path(const VecI &xa, const VecI &xb, Path::Value mode)
+{
+  size_t ndim = xa.size();
+
+  if ( xa.size() != xb.size() )
+    throw std::runtime_error("'xa' and 'xb' must have the same dimension");
+
+  if ( ndim < 1 or ndim > 3 )
+    throw std::runtime_error("Only allowed in 1, 2, or 3 dimensions");
+
+  // copy to 3-d
+  int a[3] = {0,0,0};
+  int b[3] = {0,0,0};
+
+  for ( size_t i = 0 ; i < ndim ; ++i ) { a[i] = xa[i]; b[i] = xb[i]; }
+
+  // number of voxels (without storing them), then allocate and fill
+  size_t n = pathFill(mode, a, b, ndim, nullptr, 0);
+
+  MatI ret(n, ndim);
+
+  pathFill(mode, a, b, ndim, ret.data(), n);
+
+  return ret;
+}
+
+// -------------------------------------------------------------------------------------------------
+
+MatI path(const VecI &xa, const VecI &xb, std::string mode)
+{
+  return path(xa, xb, pathMode(mode));
+}
+
+// =================================================================================================
+// pixel/voxel paths between many pairs of points "xa(k,:)" and "xb(k,:)", concatenated
+// =================================================================================================
+
+std::tuple<MatI,VecS> paths(const MatI &xa, const MatI &xb, std::string mode, size_t nthreads)
+{
+  // checks
+  std::string name = "GooseEYE::paths - ";
+  if ( xa.shape() != xb.shape() )
+    throw std::runtime_error(name+"shape inconsistent");
+  if ( xa.shape(1) < 1 or xa.shape(1) > 3 )
+    throw std::runtime_error(name+"only allowed in 1, 2, or 3 dimensions");
+
+  // interpret "mode" only once
+  Path::Value pmode = pathMode(mode);
+
+  // number of pairs of points, and number of dimensions
+  size_t npair = xa.shape(0);
+  size_t ndim  = xa.shape(1);
+
+  // copy points of pair "k" to 3-d
+  auto points = [&](size_t k, int a[3], int b[3]) {
+    for ( size_t i = 0 ; i < 3    ; ++i ) { a[i] = 0;       b[i] = 0;       }
+    for ( size_t i = 0 ; i < ndim ; ++i ) { a[i] = xa(k,i); b[i] = xb(k,i); }
+  };
+
+  // distribute blocks of pairs over the threads
+  size_t nblock = 256;
+  size_t ntask  = ( npair + nblock - 1 ) / nblock;
+
+  // number of voxels in each path (without storing them), as offsets: path "k" is stored in rows
+  // "offset[k]" to "offset[k+1]"
+  VecS offset(npair+1, 0);
+
+  Private::parallel_for(ntask, nthreads, [&](size_t itask, size_t) {
+    int a[3], b[3];
+    for ( size_t k = itask*nblock ; k < std::min((itask+1)*nblock, npair) ; ++k ) {
+      points(k, a, b);
+      offset[k+1] = pathFill(pmode, a, b, ndim, nullptr, 0);
+    }
+  });
+
+  std::partial_sum(offset.begin(), offset.end(), offset.begin());
+
+  // allocate and fill
+  MatI ret(offset[npair], ndim);
+
+  Private::parallel_for(ntask, nthreads, [&](size_t itask, size_t) {
+    int a[3], b[3];
+    for ( size_t k = itask*nblock ; k < std::min((itask+1)*nblock, npair) ; ++k ) {
+      points(k, a, b);
+      pathFill(pmode, a, b, ndim, &ret(offset[k],0), offset[k+1]-offset[k]);
+    }
+  });
+
+  return std::make_tuple(ret, offset);
+}
+
 // =================================================================================================
 
 } // namespace ...
@@ -0,0 +1,142 @@
+/* =================================================================================================
+
+(c - GPLv3) T.W.J. de Geus (Tom) | tom@geus.me | www.geus.me | github.com/tdegeus/GooseEYE
+
+================================================================================================= */
+
+#ifndef GOOSEEYE_PATH_OFFSETS_HPP
+#define GOOSEEYE_PATH_OFFSETS_HPP
+
+// =================================================================================================
+
+#include "GooseEYE.h"
+
+// =================================================================================================
+
+namespace GooseEYE {
+namespace Private {
+
+// -------------------------------------------------------------------------------------------------
+// Voxel-path stored as linear memory offsets: in the image (for a given shape), and in the
+// region-of-interest (relative to its midpoint). Away from the image's edges, a path starting at
+// (h,i,j) is traversed by adding "img()[ipix]" to the linear index of (h,i,j). Near the edges the
+// (periodic) index is available through "index(...)".
+// -------------------------------------------------------------------------------------------------
+
+class PathOffsets
+{
+private:
+
+  std::vector<int>       mDx;       // voxel displacement: [ [dh, di, dj], ... ]
+  std::vector<ptrdiff_t> mImg;      // linear offset in the image
+  std::vector<size_t>    mRoi;      // linear index in the region-of-interest
+  int                    mShape[3]; // shape of the image
+  int                    mLow  [3]; // lower bound of the displacement along each axis
+  int                    mHigh [3]; // upper bound of the displacement along each axis
+
+public:
+
+  // constructors
+  PathOffsets() = default;
+  PathOffsets(const MatI &pix, const int shape[3], const int roi[3]);
+
+  // number of voxels in the path
+  size_t size() const { return mImg.size(); }
+
+  // linear offsets in the image, and linear indices in the region-of-interest
+  const std::vector<ptrdiff_t>& img() const { return mImg; }
+  const std::vector<size_t>&    roi() const { return mRoi; }
+
+  // check if the path starting at (h,i,j) lies entirely inside the image
+  bool interior(int h, int i, int j) const;
+
+  // (periodic) linear index of voxel "ipix" of the path starting at (h,i,j)
+  size_t index(size_t ipix, int h, int i, int j) const;
+};
+
+// =================================================================================================
+// constructor: convert the voxel-path "pix" (relative to the origin) to linear offsets
+// =================================================================================================
+
+inline
+PathOffsets::PathOffsets(const MatI &pix, const int shape[3], const int roi[3])
+{
+  // number of voxels in the path, and number of dimensions stored in "pix"
+  size_t n  = pix.shape(0);
+  size_t nd = std::min(pix.shape(1), static_cast<size_t>(3));
+
+  // copy shapes
+  for ( size_t i = 0 ; i < 3 ; ++i ) mShape[i] = shape[i];
+
+  // initialize bounding box of the path
+  for ( size_t i = 0 ; i < 3 ; ++i ) { mLow[i] = 0; mHigh[i] = 0; }
+
+  // allocate
+  mDx .resize(3*n, 0);
+  mImg.resize(  n);
+  mRoi.resize(  n);
+
+  // loop over voxel-path
+  for ( size_t ipix = 0 ; ipix < n ; ++ipix )
+  {
+    // - copy displacement, update bounding box
+    for ( size_t i = 0 ; i < nd ; ++i ) {
+      mDx[3*ipix+i] = pix(ipix,i);
+      mLow [i] = std::min(mLow [i], pix(ipix,i));
+      mHigh[i] = std::max(mHigh[i], pix(ipix,i));
+    }
+
+    // - alias
+    int dh = mDx[3*ipix+0];
+    int di = mDx[3*ipix+1];
+    int dj = mDx[3*ipix+2];
+
+    // - linear offset in the image (may be negative)
+    mImg[ipix] = ( static_cast<ptrdiff_t>(dh) * shape[1] + di ) * shape[2] + dj;
+
+    // - linear index in the region-of-interest (relative to its midpoint)
+    mRoi[ipix] = static_cast<size_t>(
+      ( (dh+(roi[0]-1)/2) * roi[1] + (di+(roi[1]-1)/2) ) * roi[2] + (dj+(roi[2]-1)/2) );
+  }
+}
+
+// =================================================================================================
+// check if the entire path, starting at (h,i,j), lies inside the image (without periodicity)
+// =================================================================================================
+
+inline
+bool PathOffsets::interior(int h, int i, int j) const
+{
+  if ( h+mLow[0] < 0 or h+mHigh[0] >= mShape[0] ) return false;
+  if ( i+mLow[1] < 0 or i+mHigh[1] >= mShape[1] ) return false;
+  if ( j+mLow[2] < 0 or j+mHigh[2] >= mShape[2] ) return false;
+
+  return true;
+}
+
+// =================================================================================================
+// linear index of voxel "ipix" of the path starting at (h,i,j), wrapped periodically
+// =================================================================================================
+
+inline
+size_t PathOffsets::index(size_t ipix, int h, int i, int j) const
+{
+  int H = mShape[0];
+  int I = mShape[1];
+  int J = mShape[2];
+
+  h = ( ( h + mDx[3*ipix+0] ) % H + H ) % H;
+  i = ( ( i + mDx[3*ipix+1] ) % I + I ) % I;
+  j = ( ( j + mDx[3*ipix+2] ) % J + J ) % J;
+
+  return ( static_cast<size_t>(h) * I + i ) * J + j;
+}
+
+// =================================================================================================
+
+} // namespace Private
+} // namespace GooseEYE
+
+// =================================================================================================
+
+#endif
@@ -0,0 +1,226 @@
+/* =================================================================================================
+
+(c - GPLv3) T.W.J. de Geus (Tom) | tom@geus.me | www.geus.me | github.com/tdegeus/GooseEYE
+
+================================================================================================= */
+
+#ifndef GOOSEEYE_PATH_TREE_HPP
+#define GOOSEEYE_PATH_TREE_HPP
+
+// =================================================================================================
+
+#include "GooseEYE.h"
+
+// =================================================================================================
+
+namespace GooseEYE {
+namespace Private {
+
+// -------------------------------------------------------------------------------------------------
+// Voxel-paths that all start in the origin, merged into a prefix-tree ("trie"). Each node is a
+// voxel of one or more paths; "count(k)" is the number of paths that pass through node "k". The
+// nodes are stored in depth-first (pre-)order, such that a subtree is the contiguous range
+// "[k, next(k))". Like "PathOffsets", nodes are stored as linear offsets in the image and in the
+// region-of-interest.
+// -------------------------------------------------------------------------------------------------
+
+class PathTree
+{
+private:
+
+  std::vector<int>       mDx;       // voxel displacement: [ [dh, di, dj], ... ]
+  std::vector<ptrdiff_t> mImg;      // linear offset in the image
+  std::vector<size_t>    mRoi;      // linear index in the region-of-interest
+  std::vector<size_t>    mNext;     // first node after the subtree of each node
+  std::vector<double>    mCount;    // number of paths through each node
+  int                    mShape[3]; // shape of the image
+  int                    mLow  [3]; // lower bound of the displacement along each axis
+  int                    mHigh [3]; // upper bound of the displacement along each axis
+
+public:
+
+  // constructors
+  PathTree() = default;
+  PathTree(const std::vector<MatI> &paths, const int shape[3], const int roi[3]);
+
+  // number of nodes
+  size_t size() const { return mImg.size(); }
+
+  // per node: linear offset in the image, linear index in the ROI, end of subtree, multiplicity
+  const std::vector<ptrdiff_t>& img  () const { return mImg;   }
+  const std::vector<size_t>&    roi  () const { return mRoi;   }
+  const std::vector<size_t>&    next () const { return mNext;  }
+  const std::vector<double>&    count() const { return mCount; }
+
+  // check if all paths starting at (h,i,j) lie entirely inside the image
+  bool interior(int h, int i, int j) const;
+
+  // (periodic) linear index of node "k" for paths starting at (h,i,j)
+  size_t index(size_t k, int h, int i, int j) const;
+};
+
+// =================================================================================================
+// constructor: merge the voxel-paths "paths" (each relative to the origin)
+// =================================================================================================
+
+inline
+PathTree::PathTree(const std::vector<MatI> &paths, const int shape[3], const int roi[3])
+{
+  // copy shapes
+  for ( size_t i = 0 ; i < 3 ; ++i ) mShape[i] = shape[i];
+
+  // initialize bounding box of the paths
+  for ( size_t i = 0 ; i < 3 ; ++i ) { mLow[i] = 0; mHigh[i] = 0; }
+
+  // temporary tree: displacement, multiplicity, and children of each node
+  std::vector<int>                 dx;
+  std::vector<double>              count;
+  std::vector<std::vector<size_t>> children;
+
+  // root: the origin (shared by all paths)
+  dx      .insert(dx.end(), {0,0,0});
+  count   .push_back(0.);
+  children.push_back({});
+
+  // insert all paths
+  for ( auto &pix : paths )
+  {
+    // - number of dimensions stored in "pix"
+    size_t nd = std::min(pix.shape(1), static_cast<size_t>(3));
+
+    // - check that the path starts in the origin
+    for ( size_t i = 0 ; i < nd ; ++i )
+      if ( pix(0,i) != 0 )
+        throw std::runtime_error("GooseEYE::Private::PathTree - paths must start in the origin");
+
+    // - current node
+    size_t node = 0;
+    count[node] += 1.;
+
+    // - walk the path, adding nodes where needed
+    for ( size_t ipix = 1 ; ipix < pix.shape(0) ; ++ipix )
+    {
+      // -- displacement of the current voxel
+      int x[3] = {0,0,0};
+      for ( size_t i = 0 ; i < nd ; ++i ) {
+        x[i]     = pix(ipix,i);
+        mLow [i] = std::min(mLow [i], x[i]);
+        mHigh[i] = std::max(mHigh[i], x[i]);
+      }
+
+      // -- find child with the same displacement
+      size_t child = 0;
+      bool   found = false;
+      for ( auto &c : children[node] ) {
+        if ( dx[3*c+0] == x[0] and dx[3*c+1] == x[1] and dx[3*c+2] == x[2] ) {
+          child = c;
+          found = true;
+          break;
+        }
+      }
+
+      // -- add new child
+      if ( ! found ) {
+        child = count.size();
+        dx      .insert(dx.end(), {x[0],x[1],x[2]});
+        count   .push_back(0.);
+        children.push_back({});
+        children[node].push_back(child);
+      }
+
+      // -- proceed
+      node         = child;
+      count[node] += 1.;
+    }
+  }
+
+  // allocate
+  size_t n = count.size();
+  mDx   .resize(3*n);
+  mImg  .resize(  n);
+  mRoi  .resize(  n);
+  mNext .resize(  n);
+  mCount.resize(  n);
+
+  // store in depth-first order (explicit stack: nodes to visit)
+  std::vector<size_t> stack(1, 0);
+  std::vector<size_t> up(n);      // parent of each temporary node (new index)
+  std::vector<size_t> parent(n);  // parent of each node (new index)
+  size_t k = 0;
+
+  while ( stack.size() > 0 )
+  {
+    // - pop node, store under the new index "k"
+    size_t node = stack.back();
+    stack.pop_back();
+
+    // - copy data
+    int dh = dx[3*node+0];
+    int di = dx[3*node+1];
+    int dj = dx[3*node+2];
+    mDx[3*k+0] = dh;
+    mDx[3*k+1] = di;
+    mDx[3*k+2] = dj;
+    mCount[k]  = count[node];
+    parent[k]  = up[node];
+    mImg  [k]  = ( static_cast<ptrdiff_t>(dh) * shape[1] + di ) * shape[2] + dj;
+    mRoi  [k]  = static_cast<size_t>(
+      ( (dh+(roi[0]-1)/2) * roi[1] + (di+(roi[1]-1)/2) ) * roi[2] + (dj+(roi[2]-1)/2) );
+
+    // - push children (reversed, such that they are visited in the order of insertion)
+    for ( auto it = children[node].rbegin() ; it != children[node].rend() ; ++it ) {
+      stack.push_back(*it);
+      up[*it] = k;
+    }
+
+    ++k;
+  }
+
+  // end of subtrees: the first node after "k" that is not a descendant of "k"
+  // (a node's subtree ends where its last descendant's subtree ends)
+  // (children have a larger index than their parent: loop backwards to finalize them first)
+  for ( size_t c = 0 ; c < n ; ++c ) mNext[c] = c+1;
+
+  for ( size_t c = n-1 ; c > 0 ; --c ) mNext[parent[c]] = std::max(mNext[parent[c]], mNext[c]);
+}
+
+// =================================================================================================
+// check if all paths starting at (h,i,j) lie entirely inside the image (without periodicity)
+// =================================================================================================
+
+inline
+bool PathTree::interior(int h, int i, int j) const
+{
+  if ( h+mLow[0] < 0 or h+mHigh[0] >= mShape[0] ) return false;
+  if ( i+mLow[1] < 0 or i+mHigh[1] >= mShape[1] ) return false;
+  if ( j+mLow[2] < 0 or j+mHigh[2] >= mShape[2] ) return false;
+
+  return true;
+}
+
+// =================================================================================================
+// linear index of node "k" for paths starting at (h,i,j), wrapped periodically
+// =================================================================================================
+
+inline
+size_t PathTree::index(size_t k, int h, int i, int j) const
+{
+  int H = mShape[0];
+  int I = mShape[1];
+  int J = mShape[2];
+
+  h = ( ( h + mDx[3*k+0] ) % H + H ) % H;
+  i = ( ( i + mDx[3*k+1] ) % I + I ) % I;
+  j = ( ( j + mDx[3*k+2] ) % J + J ) % J;
+
+  return ( static_cast<size_t>(h) * I + i ) * J + j;
+}
+
+// =================================================================================================
+
+} // namespace Private
+} // namespace GooseEYE
+
+// =================================================================================================
+
+#endif
@@ -34,12 +34,118 @@ typedef const GooseEYE::VecI cVecI;
 
 // =================================================================================================
 
+// label image as "uint16" if all labels fit, or else as "uint32" (see "GooseEYE::labelBits")
+py::object compact(cArrI &labels)
+{
+  if ( M::labelBits(labels) == 16 ) return py::cast(M::compactLabels<uint16_t>(labels));
+
+  return py::cast(M::compactLabels<uint32_t>(labels));
+}
+
+// labels and centres as compact label images (see "compact")
+py::tuple compact(const std::tuple<ArrI,ArrI> &labels)
+{
+  return py::make_tuple(compact(std::get<0>(labels)), compact(std::get<1>(labels)));
+}
+
+// =================================================================================================
+
 PYBIND11_MODULE(GooseEYE, m) {
 
 m.doc() = "Geometrical statistics";
 
 // =================================================================================================
 
+py::class_<M::ClusterSet>(m, "ClusterSet")
+  // -
+  .def(py::init<cArrI &, bool, size_t>(), "ClusterSet", py::arg("f"), py::arg("periodic")=true, py::arg("nthreads")=1)
+  .def(py::init<cArrI &, cArrI &, int, bool, size_t>(), "ClusterSet", py::arg("f"), py::arg("kern"), py::arg("min_size")=0, py::arg("periodic")=true, py::arg("nthreads")=1)
+  // -
+  .def("size"      , &M::ClusterSet::size      )
+  .def("periodic"  , &M::ClusterSet::periodic  )
+  .def("labelBits" , &M::ClusterSet::labelBits )
+  .def("labels"    , [](const M::ClusterSet &s){ return s.labelBits() == 16 ? py::cast(s.labels16()) : py::cast(s.labels32()); })
+  .def("centres"   , [](const M::ClusterSet &s){ return compact(s.centres()); })
+  .def("centreList", &M::ClusterSet::centreList)
+  .def("boxes"     , &M::ClusterSet::boxes     )
+  // -
+  .def("__repr__",
+    [](const M::ClusterSet &){ return "<GooseEYE.ClusterSet>"; }
+  );
+
+// =================================================================================================
+
+py::class_<M::ClusterTable>(m, "ClusterTable")
+  // -
+  .def(py::init<cArrI &, bool>(), "ClusterTable", py::arg("labels"), py::arg("periodic")=true)
+  // -
+  .def("size"     , &M::ClusterTable::size     )
+  .def("sizes"    , &M::ClusterTable::sizes    )
+  .def("centroids", &M::ClusterTable::centroids)
+  .def("boxes"    , &M::ClusterTable::boxes    )
+  .def("moments"  , &M::ClusterTable::moments  )
+  // -
+  .def("__repr__",
+    [](const M::ClusterTable &){ return "<GooseEYE.ClusterTable>"; }
+  );
+
+// =================================================================================================
+
+py::class_<M::ClusterStream>(m, "ClusterStream")
+  // -
+  .def(py::init<cVecS &,          bool>(), "ClusterStream", py::arg("shape"),                  py::arg("periodic")=true)
+  .def(py::init<cVecS &, cArrI &, bool>(), "ClusterStream", py::arg("shape"), py::arg("kern"), py::arg("periodic")=true)
+  // -
+  .def("slices", &M::ClusterStream::slices)
+  .def("push"  , &M::ClusterStream::push  , py::arg("slice"))
+  .def("close" , &M::ClusterStream::close )
+  .def("pop"   , &M::ClusterStream::pop   )
+  // -
+  .def("__repr__",
+    [](const M::ClusterStream &){ return "<GooseEYE.ClusterStream>"; }
+  );
+
+// =================================================================================================
+
+py::class_<M::ClusterTracker>(m, "ClusterTracker")
+  // -
+  .def(py::init<cArrI &,          bool>(), "ClusterTracker", py::arg("f"),                  py::arg("periodic")=true)
+  .def(py::init<cArrI &, cArrI &, bool>(), "ClusterTracker", py::arg("f"), py::arg("kern"), py::arg("periodic")=true)
+  // -
+  .def("update", py::overload_cast<cArrI &         >(&M::ClusterTracker::update), py::arg("f"))
+  .def("update", py::overload_cast<cVecS &, cVecI &>(&M::ClusterTracker::update), py::arg("index"), py::arg("value"))
+  // -
+  .def("image" , &M::ClusterTracker::image)
+  .def("labels", [](const M::ClusterTracker &s){ return compact(s.labels()); })
+  .def("size"  , &M::ClusterTracker::size )
+  .def("sizes" , &M::ClusterTracker::sizes)
+  // -
+  .def("__repr__",
+    [](const M::ClusterTracker &){ return "<GooseEYE.ClusterTracker>"; }
+  );
+
+// =================================================================================================
+
+py::class_<M::Percolation>(m, "Percolation")
+  // -
+  .def(py::init<cArrI &,          bool>(), "Percolation", py::arg("f"),                  py::arg("periodic")=true)
+  .def(py::init<cArrI &, cArrI &, bool>(), "Percolation", py::arg("f"), py::arg("kern"), py::arg("periodic")=true)
+  // -
+  .def("count"     , &M::Percolation::count )
+  .def("size"      , &M::Percolation::size  )
+  .def("labels"    , &M::Percolation::labels)
+  .def("sizes"     , &M::Percolation::sizes )
+  .def("faces"     , &M::Percolation::faces )
+  .def("spans"     , &M::Percolation::spans )
+  .def("percolates", py::overload_cast<size_t>(&M::Percolation::percolates, py::const_), py::arg("axis"))
+  .def("percolates", py::overload_cast<      >(&M::Percolation::percolates, py::const_))
+  // -
+  .def("__repr__",
+    [](const M::Percolation &){ return "<GooseEYE.Percolation>"; }
+  );
+
+// =================================================================================================
+
 py::class_<M::Ensemble>(m, "Ensemble")
   // -
   .def(py::init<cVecS &, bool, bool>(), "Ensemble", py::arg("roi"), py::arg("periodic")=true, py::arg("zero_pad")=false)
@@ -65,17 +171,24 @@ py::class_<M::Ensemble>(m, "Ensemble")
   .def("W2"      , py::overload_cast<ArrI, ArrD      >(&M::Ensemble::W2), py::arg("w"), py::arg("f"))
   .def("W2"      , py::overload_cast<ArrI, ArrD, ArrI>(&M::Ensemble::W2), py::arg("w"), py::arg("f"), py::arg("fmask"))
   // -
-  .def("W2c"     , py::overload_cast<ArrI, ArrI, ArrI,       std::string>(&M::Ensemble::W2c), py::arg("clus"), py::arg("cntr"), py::arg("f"),                   py::arg("mode")="Bresenham")
-  .def("W2c"     , py::overload_cast<ArrI, ArrI, ArrI, ArrI, std::string>(&M::Ensemble::W2c), py::arg("clus"), py::arg("cntr"), py::arg("f"), py::arg("fmask"), py::arg("mode")="Bresenham")
-  .def("W2c"     , py::overload_cast<ArrI, ArrI, ArrD,       std::string>(&M::Ensemble::W2c), py::arg("clus"), py::arg("cntr"), py::arg("f"),                   py::arg("mode")="Bresenham")
-  .def("W2c"     , py::overload_cast<ArrI, ArrI, ArrD, ArrI, std::string>(&M::Ensemble::W2c), py::arg("clus"), py::arg("cntr"), py::arg("f"), py::arg("fmask"), py::arg("mode")="Bresenham")
+  .def("W2c"     , py::overload_cast<ArrI, ArrI, ArrI,       std::string, size_t>(&M::Ensemble::W2c), py::arg("clus"), py::arg("cntr"), py::arg("f"),                   py::arg("mode")="Bresenham", py::arg("nthreads")=1)
+  .def("W2c"     , py::overload_cast<ArrI, ArrI, ArrI, ArrI, std::string, size_t>(&M::Ensemble::W2c), py::arg("clus"), py::arg("cntr"), py::arg("f"), py::arg("fmask"), py::arg("mode")="Bresenham", py::arg("nthreads")=1)
+  .def("W2c"     , py::overload_cast<ArrI, ArrI, ArrD,       std::string, size_t>(&M::Ensemble::W2c), py::arg("clus"), py::arg("cntr"), py::arg("f"),                   py::arg("mode")="Bresenham", py::arg("nthreads")=1)
+  .def("W2c"     , py::overload_cast<ArrI, ArrI, ArrD, ArrI, std::string, size_t>(&M::Ensemble::W2c), py::arg("clus"), py::arg("cntr"), py::arg("f"), py::arg("fmask"), py::arg("mode")="Bresenham", py::arg("nthreads")=1)
+  .def("W2c"     , py::overload_cast<const M::ClusterSet &, ArrI,       std::string, size_t>(&M::Ensemble::W2c), py::arg("clus"), py::arg("f"),                   py::arg("mode")="Bresenham", py::arg("nthreads")=1)
+  .def("W2c"     , py::overload_cast<const M::ClusterSet &, ArrI, ArrI, std::string, size_t>(&M::Ensemble::W2c), py::arg("clus"), py::arg("f"), py::arg("fmask"), py::arg("mode")="Bresenham", py::arg("nthreads")=1)
+  .def("W2c"     , py::overload_cast<const M::ClusterSet &, ArrD,       std::string, size_t>(&M::Ensemble::W2c), py::arg("clus"), py::arg("f"),                   py::arg("mode")="Bresenham", py::arg("nthreads")=1)
+  .def("W2c"     , py::overload_cast<const M::ClusterSet &, ArrD, ArrI, std::string, size_t>(&M::Ensemble::W2c), py::arg("clus"), py::arg("f"), py::arg("fmask"), py::arg("mode")="Bresenham", py::arg("nthreads")=1)
   // -
-  .def("W2c_auto", py::overload_cast<ArrI, ArrI,       std::string>(&M::Ensemble::W2c_auto), py::arg("w"), py::arg("f"),                   py::arg("mode")="Bresenham")
-  .def("W2c_auto", py::overload_cast<ArrI, ArrI, ArrI, std::string>(&M::Ensemble::W2c_auto), py::arg("w"), py::arg("f"), py::arg("fmask"), py::arg("mode")="Bresenham")
-  .def("W2c_auto", py::overload_cast<ArrI, ArrD,       std::string>(&M::Ensemble::W2c_auto), py::arg("w"), py::arg("f"),                   py::arg("mode")="Bresenham")
-  .def("W2c_auto", py::overload_cast<ArrI, ArrD, ArrI, std::string>(&M::Ensemble::W2c_auto), py::arg("w"), py::arg("f"), py::arg("fmask"), py::arg("mode")="Bresenham")
+  .def("W2c_auto", py::overload_cast<ArrI, ArrI,       std::string, size_t>(&M::Ensemble::W2c_auto), py::arg("w"), py::arg("f"),                   py::arg("mode")="Bresenham", py::arg("nthreads")=1)
+  .def("W2c_auto", py::overload_cast<ArrI, ArrI, ArrI, std::string, size_t>(&M::Ensemble::W2c_auto), py::arg("w"), py::arg("f"), py::arg("fmask"), py::arg("mode")="Bresenham", py::arg("nthreads")=1)
+  .def("W2c_auto", py::overload_cast<ArrI, ArrD,       std::string, size_t>(&M::Ensemble::W2c_auto), py::arg("w"), py::arg("f"),                   py::arg("mode")="Bresenham", py::arg("nthreads")=1)
+  .def("W2c_auto", py::overload_cast<ArrI, ArrD, ArrI, std::string, size_t>(&M::Ensemble::W2c_auto), py::arg("w"), py::arg("f"), py::arg("fmask"), py::arg("mode")="Bresenham", py::arg("nthreads")=1)
   // -
-  .def("L", &M::Ensemble::L, py::arg("f"), py::arg("mode")="Bresenham")
+  .def("L", &M::Ensemble::L, py::arg("f"), py::arg("mode")="Bresenham", py::arg("trie")=false)
+  .def("L_direction", &M::Ensemble::L_direction, py::arg("f"), py::arg("direction"))
+  // -
+  .def("chordLength", &M::Ensemble::chordLength, py::arg("f"), py::arg("direction"), py::arg("phase")=1)
   // -
   .def("stampPoints", &M::Ensemble::stampPoints, py::arg("nd")=0)
   // -
@@ -99,39 +212,57 @@ m.def("W2"      , py::overload_cast<cVecS &, cArrD &, cArrI &, cArrI &, bool, bo
 m.def("W2"      , py::overload_cast<cVecS &, cArrD &, cArrD &,          bool, bool>(&M::W2), py::arg("roi"), py::arg("w"), py::arg("f"),                   py::arg("periodic")=true, py::arg("pad")=false);
 m.def("W2"      , py::overload_cast<cVecS &, cArrD &, cArrD &, cArrI &, bool, bool>(&M::W2), py::arg("roi"), py::arg("w"), py::arg("f"), py::arg("fmask"), py::arg("periodic")=true, py::arg("pad")=false);
 // -
-m.def("W2c"     , py::overload_cast<cVecS &, cArrI &, cArrI &, cArrI &,          bool, std::string>(&M::W2c), py::arg("roi"), py::arg("clus"), py::arg("cntr"), py::arg("f"),                   py::arg("periodic")=true, py::arg("mode")="Bresenham");
-m.def("W2c"     , py::overload_cast<cVecS &, cArrI &, cArrI &, cArrI &, cArrI &, bool, std::string>(&M::W2c), py::arg("roi"), py::arg("clus"), py::arg("cntr"), py::arg("f"), py::arg("fmask"), py::arg("periodic")=true, py::arg("mode")="Bresenham");
-m.def("W2c"     , py::overload_cast<cVecS &, cArrI &, cArrI &, cArrD &,          bool, std::string>(&M::W2c), py::arg("roi"), py::arg("clus"), py::arg("cntr"), py::arg("f"),                   py::arg("periodic")=true, py::arg("mode")="Bresenham");
-m.def("W2c"     , py::overload_cast<cVecS &, cArrI &, cArrI &, cArrD &, cArrI &, bool, std::string>(&M::W2c), py::arg("roi"), py::arg("clus"), py::arg("cntr"), py::arg("f"), py::arg("fmask"), py::arg("periodic")=true, py::arg("mode")="Bresenham");
+m.def("W2c"     , py::overload_cast<cVecS &, cArrI &, cArrI &, cArrI &,          bool, std::string, size_t>(&M::W2c), py::arg("roi"), py::arg("clus"), py::arg("cntr"), py::arg("f"),                   py::arg("periodic")=true, py::arg("mode")="Bresenham", py::arg("nthreads")=1);
+m.def("W2c"     , py::overload_cast<cVecS &, cArrI &, cArrI &, cArrI &, cArrI &, bool, std::string, size_t>(&M::W2c), py::arg("roi"), py::arg("clus"), py::arg("cntr"), py::arg("f"), py::arg("fmask"), py::arg("periodic")=true, py::arg("mode")="Bresenham", py::arg("nthreads")=1);
+m.def("W2c"     , py::overload_cast<cVecS &, cArrI &, cArrI &, cArrD &,          bool, std::string, size_t>(&M::W2c), py::arg("roi"), py::arg("clus"), py::arg("cntr"), py::arg("f"),                   py::arg("periodic")=true, py::arg("mode")="Bresenham", py::arg("nthreads")=1);
+m.def("W2c"     , py::overload_cast<cVecS &, cArrI &, cArrI &, cArrD &, cArrI &, bool, std::string, size_t>(&M::W2c), py::arg("roi"), py::arg("clus"), py::arg("cntr"), py::arg("f"), py::arg("fmask"), py::arg("periodic")=true, py::arg("mode")="Bresenham", py::arg("nthreads")=1);
+m.def("W2c"     , py::overload_cast<cVecS &, const M::ClusterSet &, cArrI &,          bool, std::string, size_t>(&M::W2c), py::arg("roi"), py::arg("clus"), py::arg("f"),                   py::arg("periodic")=true, py::arg("mode")="Bresenham", py::arg("nthreads")=1);
+m.def("W2c"     , py::overload_cast<cVecS &, const M::ClusterSet &, cArrI &, cArrI &, bool, std::string, size_t>(&M::W2c), py::arg("roi"), py::arg("clus"), py::arg("f"), py::arg("fmask"), py::arg("periodic")=true, py::arg("mode")="Bresenham", py::arg("nthreads")=1);
+m.def("W2c"     , py::overload_cast<cVecS &, const M::ClusterSet &, cArrD &,          bool, std::string, size_t>(&M::W2c), py::arg("roi"), py::arg("clus"), py::arg("f"),                   py::arg("periodic")=true, py::arg("mode")="Bresenham", py::arg("nthreads")=1);
+m.def("W2c"     , py::overload_cast<cVecS &, const M::ClusterSet &, cArrD &, cArrI &, bool, std::string, size_t>(&M::W2c), py::arg("roi"), py::arg("clus"), py::arg("f"), py::arg("fmask"), py::arg("periodic")=true, py::arg("mode")="Bresenham", py::arg("nthreads")=1);
+// -
+m.def("W2c_auto", py::overload_cast<cVecS &, cArrI &, cArrI &,          bool, std::string, size_t>(&M::W2c_auto), py::arg("roi"), py::arg("w"), py::arg("f"),                   py::arg("periodic")=true, py::arg("mode")="Bresenham", py::arg("nthreads")=1);
+m.def("W2c_auto", py::overload_cast<cVecS &, cArrI &, cArrI &, cArrI &, bool, std::string, size_t>(&M::W2c_auto), py::arg("roi"), py::arg("w"), py::arg("f"), py::arg("fmask"), py::arg("periodic")=true, py::arg("mode")="Bresenham", py::arg("nthreads")=1);
+m.def("W2c_auto", py::overload_cast<cVecS &, cArrI &, cArrD &,          bool, std::string, size_t>(&M::W2c_auto), py::arg("roi"), py::arg("w"), py::arg("f"),                   py::arg("periodic")=true, py::arg("mode")="Bresenham", py::arg("nthreads")=1);
+m.def("W2c_auto", py::overload_cast<cVecS &, cArrI &, cArrD &, cArrI &, bool, std::string, size_t>(&M::W2c_auto), py::arg("roi"), py::arg("w"), py::arg("f"), py::arg("fmask"), py::arg("periodic")=true, py::arg("mode")="Bresenham", py::arg("nthreads")=1);
 // -
-m.def("W2c_auto", py::overload_cast<cVecS &, cArrI &, cArrI &,          bool, std::string>(&M::W2c_auto), py::arg("roi"), py::arg("w"), py::arg("f"),                   py::arg("periodic")=true, py::arg("mode")="Bresenham");
-m.def("W2c_auto", py::overload_cast<cVecS &, cArrI &, cArrI &, cArrI &, bool, std::string>(&M::W2c_auto), py::arg("roi"), py::arg("w"), py::arg("f"), py::arg("fmask"), py::arg("periodic")=true, py::arg("mode")="Bresenham");
-m.def("W2c_auto", py::overload_cast<cVecS &, cArrI &, cArrD &,          bool, std::string>(&M::W2c_auto), py::arg("roi"), py::arg("w"), py::arg("f"),                   py::arg("periodic")=true, py::arg("mode")="Bresenham");
-m.def("W2c_auto", py::overload_cast<cVecS &, cArrI &, cArrD &, cArrI &, bool, std::string>(&M::W2c_auto), py::arg("roi"), py::arg("w"), py::arg("f"), py::arg("fmask"), py::arg("periodic")=true, py::arg("mode")="Bresenham");
+m.def("L", &M::L, py::arg("roi"), py::arg("f"), py::arg("periodic")=true, py::arg("mode")="Bresenham", py::arg("trie")=false);
+m.def("L_direction", &M::L_direction, py::arg("roi"), py::arg("f"), py::arg("direction"), py::arg("periodic")=true);
 // -
-m.def("L", &M::L, py::arg("roi"), py::arg("f"), py::arg("periodic")=true, py::arg("mode")="Bresenham");
+m.def("chordLength", &M::chordLength, py::arg("f"), py::arg("direction"), py::arg("phase")=1, py::arg("periodic")=true);
 
 // =================================================================================================
 
 m.def("dummy_circles", py::overload_cast<cVecS &,                            bool>(&M::dummy_circles), py::arg("shape"),                                               py::arg("periodic")=true);
 m.def("dummy_circles", py::overload_cast<cVecS &, cVecI &, cVecI &, cVecI &, bool>(&M::dummy_circles), py::arg("shape"), py::arg("row"), py::arg("col"), py::arg("r"), py::arg("periodic")=true);
 // -
-m.def("kernel", &M::kernel);
+m.def("kernel", &M::kernel, py::arg("ndim"), py::arg("mode")="default");
+// -
+m.def("clusters"      , [](cArrI &f,                               bool periodic, size_t nthreads){ return compact(M::clusters(f,                 periodic, nthreads)); }, py::arg("f"),                                         py::arg("periodic")=true, py::arg("nthreads")=1);
+m.def("clusters"      , [](cArrI &f,                 int min_size, bool periodic, size_t nthreads){ return compact(M::clusters(f,       min_size, periodic, nthreads)); }, py::arg("f"),                  py::arg("min_size")  , py::arg("periodic")=true, py::arg("nthreads")=1);
+m.def("clusters"      , [](cArrI &f, cArrI &kern, int min_size, bool periodic, size_t nthreads){ return compact(M::clusters(f, kern, min_size, periodic, nthreads)); }, py::arg("f"), py::arg("kern"), py::arg("min_size")=0, py::arg("periodic")=true, py::arg("nthreads")=1);
+// -
+m.def("clusterCenters", [](cArrI &f,                               bool periodic, size_t nthreads){ return compact(M::clusterCenters(f,                 periodic, nthreads)); }, py::arg("f"),                                         py::arg("periodic")=true, py::arg("nthreads")=1);
+m.def("clusterCenters", [](cArrI &f,                 int min_size, bool periodic, size_t nthreads){ return compact(M::clusterCenters(f,       min_size, periodic, nthreads)); }, py::arg("f"),                  py::arg("min_size")  , py::arg("periodic")=true, py::arg("nthreads")=1);
+m.def("clusterCenters", [](cArrI &f, cArrI &kern, int min_size, bool periodic, size_t nthreads){ return compact(M::clusterCenters(f, kern, min_size, periodic, nthreads)); }, py::arg("f"), py::arg("kern"), py::arg("min_size")=0, py::arg("periodic")=true, py::arg("nthreads")=1);
+// -
+m.def("clusterTable"  , py::overload_cast<cArrI &,                     bool        >(&M::clusterTable  ), py::arg("f"),                                         py::arg("periodic")=true);
+m.def("clusterTable"  , py::overload_cast<cArrI &, cArrI &,           bool        >(&M::clusterTable  ), py::arg("f"), py::arg("kern"),                        py::arg("periodic")=true);
+// -
+m.def("dilate", [](cArrI &f,                size_t iterations, bool periodic){ return compact(M::dilate(f,       iterations, periodic)); }, py::arg("f"),                  py::arg("iterations")=1, py::arg("periodic")=true);
+m.def("dilate", [](cArrI &f,               cVecS &iterations, bool periodic){ return compact(M::dilate(f,       iterations, periodic)); }, py::arg("f"),                  py::arg("iterations")  , py::arg("periodic")=true);
+m.def("dilate", [](cArrI &f, cArrI &kern,  size_t iterations, bool periodic){ return compact(M::dilate(f, kern, iterations, periodic)); }, py::arg("f"), py::arg("kern"), py::arg("iterations")=1, py::arg("periodic")=true);
+m.def("dilate", [](cArrI &f, cArrI &kern, cVecS &iterations, bool periodic){ return compact(M::dilate(f, kern, iterations, periodic)); }, py::arg("f"), py::arg("kern"), py::arg("iterations")  , py::arg("periodic")=true);
 // -
-m.def("clusters"      , py::overload_cast<cArrI &,               bool>(&M::clusters      ), py::arg("f"),                                         py::arg("periodic")=true);
-m.def("clusters"      , py::overload_cast<cArrI &,          int, bool>(&M::clusters      ), py::arg("f"),                  py::arg("min_size")  , py::arg("periodic")=true);
-m.def("clusters"      , py::overload_cast<cArrI &, cArrI &, int, bool>(&M::clusters      ), py::arg("f"), py::arg("kern"), py::arg("min_size")=0, py::arg("periodic")=true);
+m.def("distance"    , &M::distance, py::arg("f"), py::arg("periodic")=true);
+m.def("dilateRadius", [](cArrI &f, double radius                    , bool periodic){ return compact(M::dilateRadius(f, radius, periodic)); }, py::arg("f"), py::arg("radius"), py::arg("periodic")=true);
+m.def("dilateRadius", [](cArrI &f, const std::vector<double> &radius, bool periodic){ return compact(M::dilateRadius(f, radius, periodic)); }, py::arg("f"), py::arg("radius"), py::arg("periodic")=true);
 // -
-m.def("clusterCenters", py::overload_cast<cArrI &,               bool>(&M::clusterCenters), py::arg("f"),                                         py::arg("periodic")=true);
-m.def("clusterCenters", py::overload_cast<cArrI &,          int, bool>(&M::clusterCenters), py::arg("f"),                  py::arg("min_size")  , py::arg("periodic")=true);
-m.def("clusterCenters", py::overload_cast<cArrI &, cArrI &, int, bool>(&M::clusterCenters), py::arg("f"), py::arg("kern"), py::arg("min_size")=0, py::arg("periodic")=true);
+m.def("featureTransform", [](cArrI &f, bool periodic){ ArrI l; ArrD d; std::tie(l, d) = M::featureTransform(f, periodic); return py::make_tuple(compact(l), d); }, py::arg("f"), py::arg("periodic")=true);
 // -
-m.def("dilate", py::overload_cast<cArrI &,          size_t , bool>(&M::dilate), py::arg("f"),                  py::arg("iterations")=1, py::arg("periodic")=true);
-m.def("dilate", py::overload_cast<cArrI &,          cVecS &, bool>(&M::dilate), py::arg("f"),                  py::arg("iterations")  , py::arg("periodic")=true);
-m.def("dilate", py::overload_cast<cArrI &, cArrI &, size_t , bool>(&M::dilate), py::arg("f"), py::arg("kern"), py::arg("iterations")=1, py::arg("periodic")=true);
-m.def("dilate", py::overload_cast< ArrI  ,  ArrI  , cVecS &, bool>(&M::dilate), py::arg("f"), py::arg("kern"), py::arg("iterations")  , py::arg("periodic")=true);
+m.def("path", py::overload_cast<cVecI &, cVecI &, std::string>(&M::path), py::arg("xa"), py::arg("xb"), py::arg("mode")="Bresenham");
 // -
-m.def("path", &M::path, py::arg("xa"), py::arg("xb"), py::arg("mode")="Bresenham");
+m.def("paths", &M::paths, py::arg("xa"), py::arg("xb"), py::arg("mode")="Bresenham", py::arg("nthreads")=1);
 // -
 m.def("stampPoints", &M::stampPoints, py::arg("shape"));
 
@@ -0,0 +1,166 @@
+/* =================================================================================================
+
+(c - GPLv3) T.W.J. de Geus (Tom) | tom@geus.me | www.geus.me | github.com/tdegeus/GooseEYE
+
+================================================================================================= */
+
+#ifndef GOOSEEYE_RUNLENGTH_HPP
+#define GOOSEEYE_RUNLENGTH_HPP
+
+// =================================================================================================
+
+#include "GooseEYE.h"
+
+// =================================================================================================
+
+namespace GooseEYE {
+namespace Private {
+
+// -------------------------------------------------------------------------------------------------
+// run of consecutive voxels along a line: position of the first voxel in the line, and length
+// (for a cyclic line the run may wrap around: its "m"-th voxel is at "(begin+m)%line.size()")
+// -------------------------------------------------------------------------------------------------
+
+struct Run
+{
+  size_t begin;
+  size_t length;
+};
+
+// =================================================================================================
+// Call "func(line, cyclic)" for each line through a 3-d image of shape "shape" along "direction"
+// (each component -1, 0, or +1). "line" is the list of linear indices of the voxels along the line,
+// in the order of "direction". Every voxel is part of exactly one line.
+// - non-periodic: lines start at the edge of the image, and end when leaving the image;
+// - periodic: lines are closed cycles ("cyclic=true"), which start at an arbitrary voxel.
+// =================================================================================================
+
+template<class Func>
+inline void lines(const int shape[3], const int direction[3], bool periodic, Func func)
+{
+  int H  = shape[0];
+  int I  = shape[1];
+  int J  = shape[2];
+  int dh = direction[0];
+  int di = direction[1];
+  int dj = direction[2];
+
+  // check
+  if ( dh == 0 and di == 0 and dj == 0 )
+    throw std::runtime_error("GooseEYE::Private::lines - zero direction");
+
+  // linear index, and check to be inside the image
+  auto index  = [=](int h, int i, int j) { return ( static_cast<size_t>(h) * I + i ) * J + j; };
+  auto inside = [=](int h, int i, int j) {
+    return h >= 0 and h < H and i >= 0 and i < I and j >= 0 and j < J; };
+
+  // voxels of the current line
+  std::vector<size_t> line;
+
+  // non-periodic: start from each voxel whose predecessor is outside the image
+  if ( ! periodic )
+  {
+    for ( int h = 0 ; h < H ; ++h ) {
+      for ( int i = 0 ; i < I ; ++i ) {
+        for ( int j = 0 ; j < J ; ++j ) {
+          if ( inside(h-dh,i-di,j-dj) ) continue;
+          line.clear();
+          for ( int a = h, b = i, c = j ; inside(a,b,c) ; a += dh, b += di, c += dj )
+            line.push_back(index(a,b,c));
+          func(line, false);
+        }
+      }
+    }
+    return;
+  }
+
+  // periodic: follow each cycle, starting from the first voxel that has not yet been visited
+  std::vector<char> visited(static_cast<size_t>(H)*I*J, 0);
+
+  for ( int h = 0 ; h < H ; ++h ) {
+    for ( int i = 0 ; i < I ; ++i ) {
+      for ( int j = 0 ; j < J ; ++j ) {
+        if ( visited[index(h,i,j)] ) continue;
+        line.clear();
+        int a = h, b = i, c = j;
+        do {
+          visited[index(a,b,c)] = 1;
+          line.push_back(index(a,b,c));
+          a = ( a + dh + H ) % H;
+          b = ( b + di + I ) % I;
+          c = ( c + dj + J ) % J;
+        }
+        while ( a != h or b != i or c != j );
+        func(line, true);
+      }
+    }
+  }
+}
+
+// =================================================================================================
+// Run-length encoding of a line: list of runs of consecutive voxels for which "inPhase(index)" is
+// true. For a cyclic line, a run may continue across the end of "line". If the cyclic line is
+// entirely in the phase, a single run of the line's length is stored and "true" is returned.
+// =================================================================================================
+
+template<class Pred>
+inline bool runs(const std::vector<size_t> &line, bool cyclic, Pred inPhase, std::vector<Run> &out)
+{
+  out.clear();
+
+  size_t n = line.size();
+
+  if ( n == 0 ) return false;
+
+  // cyclic line: start directly after a voxel outside the phase, so that no run is split
+  size_t offset = 0;
+
+  if ( cyclic )
+  {
+    bool found = false;
+
+    for ( size_t k = 0 ; k < n ; ++k ) {
+      if ( ! inPhase(line[k]) ) {
+        offset = k+1;
+        found  = true;
+        break;
+      }
+    }
+
+    if ( ! found ) {
+      out.push_back({0, n});
+      return true;
+    }
+  }
+
+  // scan the line once
+  size_t begin  = 0;
+  size_t length = 0;
+
+  for ( size_t m = 0 ; m < n ; ++m )
+  {
+    size_t k = ( offset + m ) % n;
+
+    if ( inPhase(line[k]) ) {
+      if ( length == 0 ) begin = k;
+      ++length;
+    }
+    else if ( length > 0 ) {
+      out.push_back({begin, length});
+      length = 0;
+    }
+  }
+
+  if ( length > 0 ) out.push_back({begin, length});
+
+  return false;
+}
+
+// =================================================================================================
+
+} // namespace Private
+} // namespace GooseEYE
+
+// =================================================================================================
+
+#endif
@@ -0,0 +1,329 @@
+/* =================================================================================================
+
+(c - GPLv3) T.W.J. de Geus (Tom) | tom@geus.me | www.geus.me | github.com/tdegeus/GooseEYE
+
+================================================================================================= */
+
+#ifndef GOOSEEYE_UNION_FIND_HPP
+#define GOOSEEYE_UNION_FIND_HPP
+
+// =================================================================================================
+
+#include "GooseEYE.h"
+
+// =================================================================================================
+
+namespace GooseEYE {
+namespace Private {
+
+// -------------------------------------------------------------------------------------------------
+// Disjoint sets of labels "0, ..., size()-1" (union-find): union by rank, and path halving in
+// "find". Both operations take near-constant (amortized) time.
+// -------------------------------------------------------------------------------------------------
+
+class UnionFind
+{
+private:
+
+  std::vector<int> mParent; // parent of each label (a root is its own parent)
+  std::vector<int> mRank;   // upper bound of the height of the tree below each root
+
+public:
+
+  // constructors
+  UnionFind() = default;
+  explicit UnionFind(size_t n);
+
+  // number of labels
+  size_t size() const { return mParent.size(); }
+
+  // add a new (unlinked) label, return its number
+  int add();
+
+  // root of the set to which label "a" belongs
+  int find(int a);
+
+  // merge the sets to which "a" and "b" belong, return the new root
+  int unite(int a, int b);
+
+  // renumber the sets "0, 1, ..." in order of their lowest label (each label is mapped to the number
+  // of its set); the number of sets is "max+1"
+  std::vector<int> flatten();
+};
+
+// -------------------------------------------------------------------------------------------------
+// Disjoint sets of labels "0, ..., size()-1" that can be merged concurrently by several threads.
+// Sets are always linked to the set with the lowest root, such that the root of each set is its
+// lowest label (whatever the order of the merges). Roots are only changed by compare-and-swap;
+// "find" halves the path with plain stores (each label keeps pointing to a label of its own set).
+// -------------------------------------------------------------------------------------------------
+
+class ConcurrentUnionFind
+{
+private:
+
+  std::vector<std::atomic<int>> mParent; // parent of each label (a root is its own parent)
+
+public:
+
+  // constructor: "n" labels, not yet initialized (see "reset")
+  explicit ConcurrentUnionFind(size_t n) : mParent(n) {}
+
+  // number of labels
+  size_t size() const { return mParent.size(); }
+
+  // make "a" an unlinked label
+  void reset(int a) { mParent[a].store(a, std::memory_order_relaxed); }
+
+  // overwrite the parent of "a" (e.g. to store a number per root, after all merges)
+  void set(int a, int value) { mParent[a].store(value, std::memory_order_relaxed); }
+
+  // parent of "a"
+  int parent(int a) const { return mParent[a].load(std::memory_order_relaxed); }
+
+  // root of the set to which label "a" belongs
+  int find(int a);
+
+  // merge the sets to which "a" and "b" belong, return the new root (the lowest of both roots)
+  int unite(int a, int b);
+};
+
+// -------------------------------------------------------------------------------------------------
+// Disjoint sets of labels "0, ..., size()-1" (union-find) that also keep track of the relative
+// position of the labels in a set: each label has an (integer, 3-d) offset relative to the root of
+// its set. This is used to unwrap clusters that are connected across periodic edges: the offset is
+// the periodic image (in multiples of the shape of the image) in which a label has to be placed.
+// -------------------------------------------------------------------------------------------------
+
+class OffsetUnionFind
+{
+private:
+
+  std::vector<int> mParent; // parent of each label (a root is its own parent)
+  std::vector<int> mRank;   // upper bound of the height of the tree below each root
+  std::vector<int> mOffset; // offset of each label relative to its parent: [ [h, i, j], ... ]
+  std::vector<int> mPath;   // temporary: path from a label to its root
+
+public:
+
+  // constructors
+  OffsetUnionFind() = default;
+  explicit OffsetUnionFind(size_t n);
+
+  // number of labels
+  size_t size() const { return mParent.size(); }
+
+  // root of the set to which label "a" belongs, and the offset of "a" relative to it
+  int find(int a, int offset[3]);
+
+  // merge the sets to which "a" and "b" belong, such that "offset(b) - offset(a) == shift";
+  // returns "false" if "a" and "b" are already in the same set with a different relative offset
+  // (the merge is then ignored)
+  bool unite(int a, int b, const int shift[3]);
+};
+
+// =================================================================================================
+// constructor: "n" unlinked labels
+// =================================================================================================
+
+inline
+UnionFind::UnionFind(size_t n) : mParent(n), mRank(n, 0)
+{
+  std::iota(mParent.begin(), mParent.end(), 0);
+}
+
+// =================================================================================================
+// add new label
+// =================================================================================================
+
+inline
+int UnionFind::add()
+{
+  int a = static_cast<int>(mParent.size());
+
+  mParent.push_back(a);
+  mRank  .push_back(0);
+
+  return a;
+}
+
+// =================================================================================================
+// find root, halve the path on the way (each label is linked to its grandparent)
+// =================================================================================================
+
+inline
+int UnionFind::find(int a)
+{
+  while ( mParent[a] != a ) {
+    mParent[a] = mParent[mParent[a]];
+    a          = mParent[a];
+  }
+
+  return a;
+}
+
+// =================================================================================================
+// merge sets: attach the tree of lowest rank to the other
+// =================================================================================================
+
+inline
+int UnionFind::unite(int a, int b)
+{
+  a = find(a);
+  b = find(b);
+
+  if ( a == b ) return a;
+
+  if ( mRank[a] < mRank[b] ) std::swap(a, b);
+
+  mParent[b] = a;
+
+  if ( mRank[a] == mRank[b] ) mRank[a]++;
+
+  return a;
+}
+
+// =================================================================================================
+// renumber sets in order of their lowest label
+// =================================================================================================
+
+inline
+std::vector<int> UnionFind::flatten()
+{
+  std::vector<int> out(mParent.size());
+  std::vector<int> num(mParent.size(), -1);
+
+  int n = 0;
+
+  for ( size_t a = 0 ; a < mParent.size() ; ++a ) {
+    int r = find(static_cast<int>(a));
+    if ( num[r] < 0 ) num[r] = n++;
+    out[a] = num[r];
+  }
+
+  return out;
+}
+
+// =================================================================================================
+// concurrent: find root, halve the path on the way
+// =================================================================================================
+
+inline
+int ConcurrentUnionFind::find(int a)
+{
+  int p = mParent[a].load(std::memory_order_relaxed);
+
+  while ( p != a ) {
+    int g = mParent[p].load(std::memory_order_relaxed);
+    if ( g != p ) mParent[a].store(g, std::memory_order_relaxed);
+    a = p;
+    p = g;
+  }
+
+  return a;
+}
+
+// =================================================================================================
+// concurrent: merge sets, attach the highest root to the lowest root (retry if a root has changed)
+// =================================================================================================
+
+inline
+int ConcurrentUnionFind::unite(int a, int b)
+{
+  while ( true )
+  {
+    a = find(a);
+    b = find(b);
+
+    if ( a == b ) return a;
+
+    if ( a > b ) std::swap(a, b);
+
+    int expected = b;
+
+    if ( mParent[b].compare_exchange_weak(expected, a, std::memory_order_acq_rel) ) return a;
+  }
+}
+
+// =================================================================================================
+// offsets: constructor, "n" unlinked labels (at zero offset)
+// =================================================================================================
+
+inline
+OffsetUnionFind::OffsetUnionFind(size_t n) : mParent(n), mRank(n, 0), mOffset(3*n, 0)
+{
+  std::iota(mParent.begin(), mParent.end(), 0);
+}
+
+// =================================================================================================
+// offsets: find root, link all labels on the path directly to the root (accumulating the offsets)
+// =================================================================================================
+
+inline
+int OffsetUnionFind::find(int a, int offset[3])
+{
+  // path from "a" to the root (excluding the root)
+  mPath.clear();
+
+  int r = a;
+
+  while ( mParent[r] != r ) {
+    mPath.push_back(r);
+    r = mParent[r];
+  }
+
+  // compress, starting next to the root: the parent's offset is already relative to the root
+  for ( auto it = mPath.rbegin() ; it != mPath.rend() ; ++it ) {
+    int p = mParent[*it];
+    if ( p != r )
+      for ( size_t i = 0 ; i < 3 ; ++i )
+        mOffset[3*(*it)+i] += mOffset[3*p+i];
+    mParent[*it] = r;
+  }
+
+  for ( size_t i = 0 ; i < 3 ; ++i ) offset[i] = ( a == r ) ? 0 : mOffset[3*a+i];
+
+  return r;
+}
+
+// =================================================================================================
+// offsets: merge sets, attach the tree of lowest rank to the other
+// =================================================================================================
+
+inline
+bool OffsetUnionFind::unite(int a, int b, const int shift[3])
+{
+  int oa[3], ob[3];
+
+  a = find(a, oa);
+  b = find(b, ob);
+
+  // offset of root "b" relative to root "a"
+  int d[3];
+
+  for ( size_t i = 0 ; i < 3 ; ++i ) d[i] = oa[i] + shift[i] - ob[i];
+
+  if ( a == b ) return d[0] == 0 and d[1] == 0 and d[2] == 0;
+
+  if ( mRank[a] < mRank[b] ) {
+    std::swap(a, b);
+    for ( size_t i = 0 ; i < 3 ; ++i ) d[i] = -d[i];
+  }
+
+  mParent[b] = a;
+
+  for ( size_t i = 0 ; i < 3 ; ++i ) mOffset[3*b+i] = d[i];
+
+  if ( mRank[a] == mRank[b] ) mRank[a]++;
+
+  return true;
+}
+
+// =================================================================================================
+
+} // namespace Private
+} // namespace GooseEYE
+
+// =================================================================================================
+
+#endif